@@ -0,0 +1,136 @@
+#include "stream_reassembler.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+// count every heap allocation made by the process
+static size_t allocations = 0;
+
+void *operator new(size_t size) {
+    ++allocations;
+    if (void *ptr = malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept { free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { free(ptr); }
+
+constexpr size_t capacity = 64 * 1024;
+
+struct Segment {
+    size_t index;
+    size_t length;
+};
+
+struct Pattern {
+    string name;
+    size_t total;        // bytes in the stream
+    size_t segment_len;  // bytes per segment
+    size_t stride;       // distance between segment starts (< segment_len means overlap)
+    size_t copies;       // how many times each segment is pushed
+    enum { InOrder, Reversed, Shuffled } order;
+};
+
+// build the segments window by window: every segment lies inside one capacity-sized window,
+// so the whole window always fits and the reassembler never has to drop anything
+vector<Segment> make_segments(const Pattern &pattern, mt19937 &rd) {
+    vector<Segment> segments;
+    for (size_t window = 0; window < pattern.total; window += capacity) {
+        const size_t window_end = min(pattern.total, window + capacity);
+        const size_t first = segments.size();
+        for (size_t start = window; start < window_end; start += pattern.stride) {
+            for (size_t copy = 0; copy < pattern.copies; ++copy) {
+                segments.push_back({start, min(pattern.segment_len, window_end - start)});
+            }
+        }
+        if (pattern.order == Pattern::Reversed) {
+            reverse(segments.begin() + first, segments.end());
+        } else if (pattern.order == Pattern::Shuffled) {
+            shuffle(segments.begin() + first, segments.end(), rd);
+        }
+    }
+    return segments;
+}
+
+void run(const Pattern &pattern, const StreamReassembler::Mode mode) {
+    mt19937 rd{1729};
+    string data(pattern.total, 0);
+    generate(data.begin(), data.end(), [&] { return rd(); });
+    const vector<Segment> segments = make_segments(pattern, rd);
+
+    StreamReassembler reassembler{capacity, mode};
+    size_t received = 0;
+    size_t peak_unassembled = 0;
+    const size_t allocations_before = allocations;
+    const auto first_time = high_resolution_clock::now();
+
+    for (const auto &seg : segments) {
+        const bool eof = seg.index + seg.length == pattern.total;
+        reassembler.push_substring(string_view(data).substr(seg.index, seg.length), seg.index, eof);
+        peak_unassembled = max(peak_unassembled, reassembler.unassembled_bytes());
+
+        // drain the output whenever a window has been fully reassembled
+        ByteStream &out = reassembler.stream_out();
+        if (out.remaining_capacity() == 0 or out.input_ended()) {
+            const auto [first, second] = out.peek_spans();
+            if (memcmp(first.data(), data.data() + received, first.size()) or
+                memcmp(second.data(), data.data() + received + first.size(), second.size())) {
+                throw runtime_error(pattern.name + ": reassembled bytes don't match");
+            }
+            received += first.size() + second.size();
+            out.pop_output(first.size() + second.size());
+        }
+    }
+
+    const auto final_time = high_resolution_clock::now();
+    const size_t segment_allocations = allocations - allocations_before;
+
+    if (received != pattern.total or not reassembler.stream_out().eof()) {
+        throw runtime_error(pattern.name + ": stream incomplete");
+    }
+
+    const auto duration = duration_cast<nanoseconds>(final_time - first_time).count();
+
+    cout << fixed << setprecision(2);
+    cout << left << setw(12) << pattern.name << setw(13)
+         << (mode == StreamReassembler::Mode::Ring ? "ring" : "interval-map") << right << setw(10)
+         << double(duration) / pattern.total << " ns/byte" << setw(10) << peak_unassembled << " peak unassembled"
+         << setw(10) << double(segment_allocations) / segments.size() << " allocs/segment\n";
+}
+
+int main() {
+    const size_t total = 16 * 1024 * 1024;
+    const vector<Pattern> patterns = {
+        {"in-order", total, 1000, 1000, 1, Pattern::InOrder},
+        {"reversed", total, 1000, 1000, 1, Pattern::Reversed},
+        {"random", total, 1000, 1000, 1, Pattern::Shuffled},
+        {"overlap", total, 1000, 250, 1, Pattern::Shuffled},
+        {"tiny", total / 16, 1, 1, 1, Pattern::Shuffled},
+        {"duplicates", total, 1000, 1000, 8, Pattern::Shuffled},
+    };
+
+    try {
+        for (const auto &pattern : patterns) {
+            run(pattern, StreamReassembler::Mode::IntervalMap);
+            run(pattern, StreamReassembler::Mode::Ring);
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -2,9 +2,13 @@
 
 #include <chrono>
 #include <cstdlib>
+#include <functional>
 #include <iomanip>
 #include <iostream>
+#include <optional>
+#include <random>
 #include <string>
+#include <vector>
 
 using namespace std;
 using namespace std::chrono;
@@ -28,8 +32,9 @@ void move_segments(TCPConnection &x, TCPConnection &y, vector<TCPSegment> &segme
     segments.clear();
 }
 
-void main_loop(const bool reorder) {
+void main_loop(const bool reorder, const bool delayed_ack = false) {
     TCPConfig config;
+    config.delayed_ack = delayed_ack;
     TCPConnection x{config}, y{config};
 
     string string_to_send(len, 'x');
@@ -69,10 +74,13 @@ void main_loop(const bool reorder) {
         move_segments(x, y, segments, reorder);
         move_segments(y, x, segments, false);
 
-        // read output from y
+        // read output from y (straight out of the stream's storage, without a temporary string)
         const auto available_output = y.inbound_stream().buffer_size();
         if (available_output > 0) {
-            string_received.append(y.inbound_stream().read(available_output));
+            const auto [first, second] = y.inbound_stream().peek_spans();
+            string_received.append(first);
+            string_received.append(second);
+            y.inbound_stream().pop_output(first.size() + second.size());
         }
 
         // time passes
@@ -95,18 +103,194 @@ void main_loop(const bool reorder) {
     const auto gigabits_per_second = len * 8.0 / double(duration);
 
     cout << fixed << setprecision(2);
-    cout << "CPU-limited throughput" << (reorder ? " with reordering: " : "                : ") << gigabits_per_second
-         << " Gbit/s\n";
+    const char *variant = reorder ? " with reordering: " : delayed_ack ? " with ACK delay  : " : "                : ";
+    cout << "CPU-limited throughput" << variant << gigabits_per_second << " Gbit/s\n";
 
     while (x.active() or y.active()) {
         loop();
     }
 }
 
+// deliver everything x has sent to y, except the segments `drop` picks by their position in the batch;
+// y's application reads each segment as soon as it arrives, so only the congestion window limits x.
+// Returns the bytes read.
+size_t deliver(TCPConnection &x, TCPConnection &y, const function<bool(size_t)> &drop = nullptr) {
+    size_t read = 0;
+    for (size_t i = 0; not x.segments_out().empty(); ++i) {
+        if (not drop or not drop(i)) {
+            y.segment_received(move(x.segments_out().front()));
+            read += y.inbound_stream().buffer_size();
+            y.inbound_stream().pop_output(y.inbound_stream().buffer_size());
+        }
+        x.segments_out().pop();
+    }
+    return read;
+}
+
+// one segment is lost once the sender has opened its window to 40 segments; count the round trips
+// until the per-RTT goodput is back to where it was before the loss
+void loss_recovery(const CongestionControlAlgorithm algorithm, const string &name) {
+    constexpr size_t rtt = 1000;
+    TCPConfig config;
+    config.rt_timeout = 10 * rtt;
+    config.congestion_control = algorithm;
+    TCPConnection x{config}, y{config};
+
+    // finish the handshake before any data is written
+    x.connect();
+    deliver(x, y);
+    deliver(y, x);
+    deliver(x, y);
+
+    size_t before_loss = 0;
+    optional<size_t> lost_at{};
+    size_t recovered_after = 0;
+    for (size_t round = 0; round < 200 and recovered_after == 0; ++round) {
+        const string data(x.remaining_outbound_capacity(), 'x');
+        x.write(data);
+
+        // everything x sends this round is delivered and acknowledged one RTT later
+        x.tick(rtt);
+        y.tick(rtt);
+        const bool drop = not lost_at.has_value() and x.segments_out().size() >= 40;
+        if (drop) {
+            lost_at = round;
+            before_loss = x.bytes_in_flight();
+        }
+        const size_t delivered = deliver(x, y, [&](const size_t i) { return drop and i == 0; });
+        deliver(y, x);
+
+        // the round after the loss also delivers everything buffered behind the hole
+        if (lost_at.has_value() and round > *lost_at + 1 and delivered >= before_loss * 95 / 100) {
+            recovered_after = round - *lost_at;
+        }
+    }
+
+    cout << "Loss recovery " << name << ": ";
+    if (recovered_after > 0) {
+        cout << "back to 95% of the pre-loss rate after " << recovered_after << " RTTs\n";
+    } else {
+        cout << "not recovered after 200 RTTs\n";
+    }
+
+    x.end_input_stream();
+    y.end_input_stream();
+    while (x.active() or y.active()) {
+        deliver(x, y);
+        deliver(y, x);
+        x.tick(rtt);
+        y.tick(rtt);
+    }
+}
+
+// 10% of the segments are lost in each direction, as with LossyFdAdapter at -Lu 0.1 -Ld 0.1;
+// report the goodput over a simulated path with a 10 ms RTT
+void lossy_transfer(const TCPConfig &config, const string &name) {
+    constexpr size_t rtt = 10;
+    constexpr size_t total = 4 * 1024 * 1024;
+    mt19937 rd{1729};
+    bernoulli_distribution lose{0.1};
+    const auto drop = [&](const size_t) { return lose(rd); };
+    TCPConnection x{config}, y{config};
+
+    x.connect();
+    deliver(x, y);
+    deliver(y, x);
+    deliver(x, y);
+
+    size_t sent = 0, received = 0, elapsed = 0;
+    while (received < total and x.active()) {
+        const string data(min(x.remaining_outbound_capacity(), total - sent), 'x');
+        sent += x.write(data);
+        x.tick(rtt);
+        y.tick(rtt);
+        elapsed += rtt;
+        received += deliver(x, y, drop);
+        deliver(y, x, drop);
+    }
+
+    cout << fixed << setprecision(2);
+    cout << "Goodput at 10% loss, " << name << ": ";
+    if (received < total) {
+        cout << "connection reset after " << received << " bytes\n";
+    } else {
+        cout << total * 8.0 / elapsed / 1000 << " Mbit/s\n";
+    }
+
+    x.end_input_stream();
+    y.end_input_stream();
+    while (x.active() or y.active()) {
+        deliver(x, y);
+        deliver(y, x);
+        x.tick(rtt);
+        y.tick(rtt);
+    }
+}
+
+// a lossless path with a 10 ms RTT: the sender can have at most one receive window in flight per round trip,
+// so the goodput shows whether the window can grow past the 64 KiB a bare 16-bit window field allows
+void window_limited(const size_t recv_capacity, const string &name) {
+    constexpr size_t rtt = 10;
+    constexpr size_t total = 64 * 1024 * 1024;
+    TCPConfig config;
+    config.recv_capacity = recv_capacity;
+    config.send_capacity = recv_capacity;
+    TCPConnection x{config}, y{config};
+
+    x.connect();
+    deliver(x, y);
+    deliver(y, x);
+    deliver(x, y);
+
+    size_t sent = 0, received = 0, elapsed = 0;
+    while (received < total) {
+        const string data(min(x.remaining_outbound_capacity(), total - sent), 'x');
+        sent += x.write(data);
+        x.tick(rtt);
+        y.tick(rtt);
+        elapsed += rtt;
+        received += deliver(x, y);
+        deliver(y, x);
+    }
+
+    cout << fixed << setprecision(2);
+    cout << "Goodput at 10 ms RTT, " << name << ": " << total * 8.0 / elapsed / 1000 << " Mbit/s\n";
+
+    x.end_input_stream();
+    y.end_input_stream();
+    while (x.active() or y.active()) {
+        deliver(x, y);
+        deliver(y, x);
+        x.tick(rtt);
+        y.tick(rtt);
+    }
+}
+
 int main() {
     try {
         main_loop(false);
         main_loop(true);
+        main_loop(false, true);
+        loss_recovery(CongestionControlAlgorithm::NewReno, "with NewReno");
+        loss_recovery(CongestionControlAlgorithm::Cubic, "with CUBIC  ");
+
+        TCPConfig config;
+        lossy_transfer(config, "RTO only                     ");
+        config.fast_retransmit = true;
+        lossy_transfer(config, "fast retransmit              ");
+        config.adaptive_rto = true;
+        lossy_transfer(config, "fast retransmit, adaptive RTO");
+        config.sack = true;
+        lossy_transfer(config, "SACK, adaptive RTO           ");
+        config.sack = false;
+        config.congestion_control = CongestionControlAlgorithm::NewReno;
+        lossy_transfer(config, "NewReno, adaptive RTO        ");
+        config.sack = true;
+        lossy_transfer(config, "NewReno, SACK, adaptive RTO  ");
+
+        window_limited(64000, "64 KB receive window");
+        window_limited(1024 * 1024, "1 MB receive window ");
+        window_limited(8 * 1024 * 1024, "8 MB receive window ");
     } catch (const exception &e) {
         cerr << e.what() << "\n";
         return EXIT_FAILURE;
@@ -26,10 +26,25 @@ static void show_usage(const char *argv0, const char *msg) {
          << "   -w <winsz>      Use a window of <winsz> bytes                   " << TCPConfig::MAX_PAYLOAD_SIZE
          << "\n\n"
 
-         << "   -t <tmout>      Set rt_timeout to tmout                         " << TCPConfig::TIMEOUT_DFLT << "\n\n"
+         << "   -t <tmout>      Set rt_timeout to tmout                         " << TCPConfig::TIMEOUT_DFLT << "\n"
+         << "   -r              Adapt the RTO to the measured RTT (RFC 6298),   (fixed RTO)\n"
+         << "                   starting from rt_timeout\n\n"
+         << "   -f              Fast retransmit on three duplicate ACKs         (RTO only)\n"
+         << "   -S              Offer SACK and retransmit only the holes        (no SACK)\n"
+         << "   -T              Offer timestamps: RTT on every ACK, and PAWS    (no timestamps)\n"
+         << "   -p <rate>       Pace sending at <rate> bytes/s, or at the       (no pacing)\n"
+         << "                   window per RTT if <rate> is 0\n"
+         << "   -n              Nagle: hold short segments while data is        (send at once)\n"
+         << "                   unacknowledged\n"
+         << "   -D              Delay ACKs: every second segment, or after      (ACK every segment)\n"
+         << "                   " << TCPConfig::DELAYED_ACK_DFLT << " ms\n\n"
+
+         << "   -m <mtu>        Set the MTU the MSS is derived from             " << TCPConfig::MTU_DFLT << "\n"
+         << "   -P              Probe for a larger MSS up to the MTU (RFC 4821) (MSS from MTU)\n\n"
 
          << "   -Lu <loss>      Set uplink loss to <rate> (float in 0..1)       (no loss)\n"
-         << "   -Ld <loss>      Set downlink loss to <rate> (float in 0..1)     (no loss)\n\n"
+         << "   -Ld <loss>      Set downlink loss to <rate> (float in 0..1)     (no loss)\n"
+         << "   -Lm <mtu>       Drop outgoing datagrams larger than <mtu>       (no limit)\n\n"
 
          << "   -h              Show this message and quit.\n\n";
 
@@ -68,6 +83,45 @@ static tuple<TCPConfig, FdAdapterConfig, bool> get_config(int argc, char **argv)
             c_fsm.rt_timeout = strtol(argv[curr + 1], nullptr, 0);
             curr += 2;
 
+        } else if (strncmp("-r", argv[curr], 3) == 0) {
+            c_fsm.adaptive_rto = true;
+            curr += 1;
+
+        } else if (strncmp("-f", argv[curr], 3) == 0) {
+            c_fsm.fast_retransmit = true;
+            curr += 1;
+
+        } else if (strncmp("-S", argv[curr], 3) == 0) {
+            c_fsm.sack = true;
+            curr += 1;
+
+        } else if (strncmp("-T", argv[curr], 3) == 0) {
+            c_fsm.timestamps = true;
+            curr += 1;
+
+        } else if (strncmp("-n", argv[curr], 3) == 0) {
+            c_fsm.nagle = true;
+            curr += 1;
+
+        } else if (strncmp("-D", argv[curr], 3) == 0) {
+            c_fsm.delayed_ack = true;
+            curr += 1;
+
+        } else if (strncmp("-p", argv[curr], 3) == 0) {
+            check_argc(argc, argv, curr, "ERROR: -p requires one argument.");
+            c_fsm.pacing = true;
+            c_fsm.pacing_rate = strtoul(argv[curr + 1], nullptr, 0);
+            curr += 2;
+
+        } else if (strncmp("-m", argv[curr], 3) == 0) {
+            check_argc(argc, argv, curr, "ERROR: -m requires one argument.");
+            c_filt.mtu = strtol(argv[curr + 1], nullptr, 0);
+            curr += 2;
+
+        } else if (strncmp("-P", argv[curr], 3) == 0) {
+            c_fsm.mtu_probing = true;
+            curr += 1;
+
         } else if (strncmp("-Lu", argv[curr], 3) == 0) {
             check_argc(argc, argv, curr, "ERROR: -Lu requires one argument.");
             float lossrate = strtof(argv[curr + 1], nullptr);
@@ -84,6 +138,11 @@ static tuple<TCPConfig, FdAdapterConfig, bool> get_config(int argc, char **argv)
                 static_cast<LossRateDnT>(static_cast<float>(numeric_limits<LossRateDnT>::max()) * lossrate);
             curr += 2;
 
+        } else if (strncmp("-Lm", argv[curr], 3) == 0) {
+            check_argc(argc, argv, curr, "ERROR: -Lm requires one argument.");
+            c_filt.path_mtu = strtol(argv[curr + 1], nullptr, 0);
+            curr += 2;
+
         } else if (strncmp("-h", argv[curr], 3) == 0) {
             show_usage(argv[0], nullptr);
             exit(0);
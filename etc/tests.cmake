@@ -11,6 +11,9 @@ add_test(NAME t_recv_transmit        COMMAND recv_transmit)
 add_test(NAME t_recv_window          COMMAND recv_window)
 add_test(NAME t_recv_reorder         COMMAND recv_reorder)
 add_test(NAME t_recv_close           COMMAND recv_close)
+add_test(NAME t_recv_sack            COMMAND recv_sack)
+add_test(NAME t_recv_wscale          COMMAND recv_wscale)
+add_test(NAME t_recv_timestamps      COMMAND recv_timestamps)
 
 add_test(NAME t_send_connect         COMMAND send_connect)
 add_test(NAME t_send_transmit        COMMAND send_transmit)
@@ -18,6 +21,18 @@ add_test(NAME t_send_retx            COMMAND send_retx)
 add_test(NAME t_send_window          COMMAND send_window)
 add_test(NAME t_send_ack             COMMAND send_ack)
 add_test(NAME t_send_close           COMMAND send_close)
+add_test(NAME t_send_congestion      COMMAND send_congestion)
+add_test(NAME t_send_cubic           COMMAND send_cubic)
+add_test(NAME t_send_bbr             COMMAND send_bbr)
+add_test(NAME t_send_mtu             COMMAND send_mtu)
+add_test(NAME t_send_rto             COMMAND send_rto)
+add_test(NAME t_send_fast_retransmit COMMAND send_fast_retransmit)
+add_test(NAME t_send_sack            COMMAND send_sack)
+add_test(NAME t_send_pacing          COMMAND send_pacing)
+add_test(NAME t_send_nagle           COMMAND send_nagle)
+
+add_test(NAME t_timer_wheel          COMMAND timer_wheel)
+add_test(NAME t_sponge_socket_clock  COMMAND sponge_socket_clock)
 
 add_test(NAME t_strm_reassem_cap         COMMAND fsm_stream_reassembler_cap)
 add_test(NAME t_strm_reassem_single      COMMAND fsm_stream_reassembler_single)
@@ -27,12 +42,17 @@ add_test(NAME t_strm_reassem_holes       COMMAND fsm_stream_reassembler_holes)
 add_test(NAME t_strm_reassem_many        COMMAND fsm_stream_reassembler_many)
 add_test(NAME t_strm_reassem_overlapping COMMAND fsm_stream_reassembler_overlapping)
 add_test(NAME t_strm_reassem_win         COMMAND fsm_stream_reassembler_win)
+add_test(NAME t_strm_reassem_ring        COMMAND fsm_stream_reassembler_ring)
+add_test(NAME t_strm_reassem_budget      COMMAND fsm_stream_reassembler_budget)
 
 add_test(NAME t_byte_stream_construction COMMAND byte_stream_construction)
 add_test(NAME t_byte_stream_one_write    COMMAND byte_stream_one_write)
 add_test(NAME t_byte_stream_two_writes   COMMAND byte_stream_two_writes)
 add_test(NAME t_byte_stream_capacity     COMMAND byte_stream_capacity)
 add_test(NAME t_byte_stream_many_writes  COMMAND byte_stream_many_writes)
+add_test(NAME t_byte_stream_chunked      COMMAND byte_stream_chunked)
+add_test(NAME t_byte_stream_fd           COMMAND byte_stream_fd)
+add_test(NAME t_byte_stream_concurrent   COMMAND byte_stream_concurrent)
 
 add_test(NAME t_webget               COMMAND "${PROJECT_SOURCE_DIR}/tests/webget_t.sh")
 
@@ -49,6 +69,7 @@ add_test(NAME t_connect              COMMAND fsm_connect_relaxed)
 add_test(NAME ec_listen              COMMAND fsm_listen)
 add_test(NAME t_listen               COMMAND fsm_listen_relaxed)
 add_test(NAME t_winsize              COMMAND fsm_winsize)
+add_test(NAME t_delayed_ack          COMMAND fsm_delayed_ack)
 add_test(NAME ec_retx                COMMAND fsm_retx)
 add_test(NAME t_retx                 COMMAND fsm_retx_relaxed)
 add_test(NAME t_retx_win             COMMAND fsm_retx_win)
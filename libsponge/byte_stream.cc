@@ -1,13 +1,19 @@
 #include "byte_stream.hh"
 
+#include "file_descriptor.hh"
+#include "util.hh"
+
 #include <algorithm>
+#include <cstring>
 #include <iterator>
 #include <stdexcept>
 #include <sstream>
 
 /*
 代码功能概述
-这段代码实现了一个简单的字节流类 ByteStream，用于管理字节数据的读写操作。该类提供了写入数据、查看数据、移除数据、标记输入结束等功能，
+这段代码实现了一个简单的字节流类 ByteStream，用于管理字节数据的读写操作。底层存储是一个大小为 2 的幂的环形缓冲区，
+读写都用 memcpy 批量完成（绕回时最多拆成两段），不再逐字节操作 deque。
+另有分块模式（Mode::Chunked），存储引用计数的 Buffer 切片，整块写入 Buffer 和 peek_buffers() 都不复制数据。该类提供了写入数据、查看数据、移除数据、标记输入结束等功能，
 同时还提供了一些用于查询字节流状态的方法，如缓冲区大小、是否输入结束、是否到达末尾等。
 
 主要方法解释
@@ -24,68 +30,182 @@ void DUMMY_CODE(Targs &&... /* unused */) {}
 using namespace std;
 
 // 构造函数，初始化字节流对象，指定字节流的容量
-ByteStream::ByteStream(const size_t capacity) : _capacity(capacity) {}
-
-// 向字节流写入数据
-size_t ByteStream::write(const string &data) {
-    // 获取写入数据的长度
-    size_t len = data.length();
-    // 如果要写入数据长度超过了字节流剩余的容量
-    if (len > _capacity - _buffer.size()){
-        // 将写入长度调节为字节流剩余容量
-        len = _capacity - _buffer.size();
+// 环形模式下缓冲区一次性分配好，之后的读写都不会再分配内存；分块模式不需要环形缓冲区
+ByteStream::ByteStream(const size_t capacity, const Mode mode)
+    : _mode(mode)
+    , _buffer(mode == Mode::Ring ? round_up_pow2(capacity) : 0)
+    , _mask(_buffer.empty() ? 0 : _buffer.size() - 1)
+    , _capacity(capacity) {}
+
+// 写入一个 Buffer：分块模式下如果整块都能放下，只增加引用计数而不复制数据
+size_t ByteStream::write(const Buffer &data) {
+    if (_mode == Mode::Chunked && !data.str().empty() && data.size() <= remaining_capacity()) {
+        _chunks.push_back(data);
+        _write_count += data.size();
+        return data.size();
+    }
+    return write(data.str());
+}
+
+// 依次写入 BufferList 中的每一块，遇到只写入一部分的块就停止
+size_t ByteStream::write(const BufferList &data) {
+    size_t ret = 0;
+    for (const auto &buf : data.buffers()) {
+        const size_t len = write(buf);
+        ret += len;
+        if (len < buf.size()) {
+            break;
+        }
+    }
+    return ret;
+}
+
+// 向字节流写入数据（string、字符串字面量都可以隐式转换为 string_view）
+size_t ByteStream::write(const string_view data) {
+    // 实际写入长度不能超过剩余容量
+    const size_t len = min(data.length(), remaining_capacity());
+    if (len == 0) {
+        return 0;
+    }
+    if (_mode == Mode::Chunked) {
+        // 分块模式：只复制能放下的前缀，作为一个新的切片
+        _chunks.emplace_back(string(data.substr(0, len)));
+    } else {
+        // 写位置，以及从写位置到缓冲区末尾能连续写入的长度
+        const size_t tail = _write_count & _mask;
+        const size_t first = min(len, _buffer.size() - tail);
+        // 最多两段：先写到缓冲区末尾，剩下的绕回开头
+        memcpy(_buffer.data() + tail, data.data(), first);
+        memcpy(_buffer.data(), data.data() + first, len - first);
     }
     // 累加写入的字节数
     _write_count += len;
-    // 将数据的前len个字符添加到字符的缓冲区中
-    for(size_t i = 0; i < len; i++){
-        _buffer.push_back(data[i]);
-    }
     // 返回实际写入字节
     return len;
 }
 
+// 从 fd 直接读入字节流的存储
+// 环形模式下把空闲区域（最多两段）交给一次 readv，数据只从内核复制一次
+size_t ByteStream::read_from_fd(FileDescriptor &fd, const size_t limit) {
+    const size_t len = min(limit, remaining_capacity());
+    if (_mode == Mode::Chunked) {
+        // 分块模式没有预分配的空间，读到一个新的字符串里再整块放入
+        return write(Buffer(fd.read(len)));
+    }
+    const size_t tail = _write_count & _mask;
+    const size_t first = min(len, _buffer.size() - tail);
+    // iovec 放在栈上，读的过程中不分配内存
+    const iovec iovecs[2] = {{_buffer.data() + tail, first}, {_buffer.data(), len - first}};
+    const size_t bytes_read = fd.readv(iovecs, len > first ? 2 : 1);
+    _write_count += bytes_read;
+    return bytes_read;
+}
+
+// 把缓冲区开头的 len 个字节复制到 dst，环形模式最多两段，分块模式逐块复制
+void ByteStream::copy_out(char *dst, const size_t len) const {
+    if (_mode == Mode::Chunked) {
+        size_t copied = 0;
+        for (auto it = _chunks.begin(); it != _chunks.end() && copied < len; ++it) {
+            const size_t n = min(len - copied, it->size());
+            memcpy(dst + copied, it->str().data(), n);
+            copied += n;
+        }
+        return;
+    }
+    const size_t head = _read_count & _mask;
+    const size_t first = min(len, _buffer.size() - head);
+    memcpy(dst, _buffer.data() + head, first);
+    memcpy(dst + first, _buffer.data(), len - first);
+}
+
 // 从字节流的输出端查看指定长度的字节数据 但不将其从缓冲区移除
 string ByteStream::peek_output(const size_t len) const {
-    // // 要查看的字节长度
-    // size_t length = len;
-    // // 如果要查看的长度超过了缓冲区的大小
-    // if (length > _buffer.size()){
-    //     // 则将查看长度调整为缓冲区的大小
-    //     length = _buffer.size();
-    // }
-
-    const size_t length = std::min(len, _buffer.size());
-
-    // 从缓冲区的开始位置复制 length 个字符到一个新的字符串中并返回
-    // assign 是 std::string 类的成员函数，用于将指定范围的字符赋值给字符串对象 
-    // return string().assign(_buffer.begin(), _buffer.begin() + length);
-
-    // 可以直接使用 std::string 的构造函数进行复制
-    // 优点1：assign 方法可能会有一些额外的内部管理开销（如清空原字符串等操作），直接用string复制避免了这些开销。
-    // 优点2：直接调用string的构造函数生成了一个临时对象，然后在返回这个字符串并进行赋值的时候，不会调用拷贝构造，而是移动构造函数
-    // 拷贝构造函数会重新复制一份，而移动构造函数只会转移资源的所有权
-    
-    // move(temp)是将资源的所有权移送给别人，要求temp是一个临时对象或者右值引用。 右值引用是&&，左值引用则是&
-    // 同时可以结合移动构造函数和移动赋值函数来，与拷贝构造拷贝赋值没有很大的区别，移动构造、赋值是&&，而拷贝是&
-    return string(_buffer.begin(), _buffer.begin() + length);
+    const size_t length = min(len, buffer_size());
+    // 直接构造出目标长度的字符串再整体复制，避免逐字节 push_back
+    string ret(length, '\0');
+    copy_out(ret.data(), length);
+    return ret;
 }
 
-// 从字节流的输出端移除指定长度的字节数据
-void ByteStream::pop_output(const size_t len) { 
-    // 要移除的字节长度
-    size_t length = len;
-    // 如果要移除的长度超过了缓冲区的大小
-    if (length > _buffer.size()){
-        length = _buffer.size();
+// 复制到调用者提供的空间，不分配内存
+size_t ByteStream::peek_into(char *dst, const size_t len) const {
+    const size_t length = min(len, buffer_size());
+    copy_out(dst, length);
+    return length;
+}
+
+// 返回最多两段连续的可读区域：环形模式是读位置到缓冲区末尾以及绕回的部分，分块模式是前两个切片
+pair<string_view, string_view> ByteStream::peek_spans() const {
+    if (_mode == Mode::Chunked) {
+        return {_chunks.size() > 0 ? _chunks[0].str() : string_view{},
+                _chunks.size() > 1 ? _chunks[1].str() : string_view{}};
+    }
+    const size_t head = _read_count & _mask;
+    const size_t first = min(buffer_size(), _buffer.size() - head);
+    return {{_buffer.data() + head, first}, {_buffer.data(), buffer_size() - first}};
+}
+
+// 不复制数据，直接返回指向内部存储的视图：环形模式最多两段，分块模式每个切片一段
+BufferViewList ByteStream::peek_buffers(const size_t len) const {
+    size_t length = min(len, buffer_size());
+    BufferViewList ret;
+    if (_mode == Mode::Chunked) {
+        for (auto it = _chunks.begin(); it != _chunks.end() && length > 0; ++it) {
+            const size_t n = min(length, it->size());
+            ret.append(it->str().substr(0, n));
+            length -= n;
+        }
+        return ret;
     }
-    // 累加读取的字节数
+    const size_t head = _read_count & _mask;
+    const size_t first = min(length, _buffer.size() - head);
+    ret.append({_buffer.data() + head, first});
+    ret.append({_buffer.data(), length - first});
+    return ret;
+}
+
+// 分块模式下要读的字节都在第一个切片里时，返回共享同一存储的切片，不复制；否则复制一次
+Buffer ByteStream::read_buffer(const size_t len) {
+    const size_t length = min(len, buffer_size());
+    if (_mode == Mode::Chunked && length > 0 && length <= _chunks.front().size()) {
+        Buffer ret = _chunks.front().prefix(length);
+        pop_output(length);
+        return ret;
+    }
+    return Buffer(read(length));
+}
+
+// 把缓冲区中的数据用一次 writev 写到 fd，只弹出实际写出去的部分
+size_t ByteStream::write_to_fd(FileDescriptor &fd, const size_t limit) {
+    size_t bytes_written = 0;
+    if (_mode == Mode::Chunked) {
+        bytes_written = fd.write(peek_buffers(limit), false);
+    } else {
+        // 环形模式最多两段，直接在栈上构造 iovec
+        const auto [first, second] = peek_spans();
+        const size_t first_len = min(limit, first.size());
+        const size_t second_len = min(limit - first_len, second.size());
+        const iovec iovecs[2] = {{const_cast<char *>(first.data()), first_len},
+                                 {const_cast<char *>(second.data()), second_len}};
+        bytes_written = fd.writev(iovecs, second_len > 0 ? 2 : 1);
+    }
+    pop_output(bytes_written);
+    return bytes_written;
+}
+
+// 从字节流的输出端移除指定长度的字节数据
+// 环形模式只需要移动读位置；分块模式还要丢掉已读完的切片
+void ByteStream::pop_output(const size_t len) {
+    size_t length = min(len, buffer_size());
     _read_count += length;
-    // 循环移除缓冲区的前 length 个字符
-    while(length--){
-        _buffer.pop_front();
+    while (_mode == Mode::Chunked && length > 0) {
+        if (length < _chunks.front().size()) {
+            _chunks.front().remove_prefix(length);
+            break;
+        }
+        length -= _chunks.front().size();
+        _chunks.pop_front();
     }
-    return ;
 }
 
 // 标记输入结束
@@ -100,12 +220,12 @@ bool ByteStream::input_ended() const {
 
 // 获取字节流缓冲区的当前大小
 size_t ByteStream::buffer_size() const {
-    return _buffer.size();
+    return _write_count - _read_count;
 }
 
 // 判断字节流缓冲区是否为空
 bool ByteStream::buffer_empty() const {
-    return _buffer.size() == 0;
+    return buffer_size() == 0;
 }
 
 // 判断是否到达字节流的末尾（缓冲区为空且输入结束）
@@ -125,5 +245,5 @@ size_t ByteStream::bytes_read() const {
 
 // 获取字节流的剩余容量
 size_t ByteStream::remaining_capacity() const {
-    return _capacity - _buffer.size();
+    return _capacity - buffer_size();
 }
@@ -1,31 +1,67 @@
 #ifndef SPONGE_LIBSPONGE_BYTE_STREAM_HH
 #define SPONGE_LIBSPONGE_BYTE_STREAM_HH
 
+#include "buffer.hh"
+
 #include <cstddef>
 #include <cstdint>
 #include <deque>
 #include <list>
 #include <string>
+#include <string_view>
 #include <utility>
+#include <vector>
+
+class FileDescriptor;
 
 class ByteStream {
+  public:
+    //! 底层存储方式
+    enum class Mode {
+        Ring,    //!< 预分配的环形缓冲区，写入时复制一次
+        Chunked  //!< 引用计数的 Buffer 切片队列，写入整块 Buffer 时不复制
+    };
+
   private:
-    std::deque<char> _buffer = {}; // 使用deque<char>_buffer来作为缓冲区也就是字节流
+    Mode _mode;
+
+    // 环形缓冲区，大小为不小于 capacity 的 2 的幂，下标用 & _mask 取模
+    // 读写位置直接由 _read_count / _write_count 得到，不需要单独维护 head/tail
+    std::vector<char> _buffer = {};
+    size_t _mask = 0;
+    // 分块模式下的存储：每个元素是一段尚未读出的 Buffer 切片
+    std::deque<Buffer> _chunks = {};
     size_t _capacity = 0;
     size_t _read_count = 0;
     size_t _write_count = 0;
     bool _input_ended_flag = false;
     bool _error = false;
 
+    //! 把缓冲区开头的 `len` 个字节复制到 `dst`（最多两段 memcpy），不移动读位置
+    void copy_out(char *dst, const size_t len) const;
+
   public:
     // Construct a stream with room for `capacity` bytes.
-    ByteStream(const size_t capacity);
+    ByteStream(const size_t capacity, const Mode mode = Mode::Ring);
 
    
     // Write a string of bytes into the stream. Write as many
     // as will fit, and return how many were written.
     //! \returns the number of bytes accepted into the stream
-    size_t write(const std::string &data);
+    size_t write(const std::string_view data);
+
+    //! \brief Write a Buffer; in Mode::Chunked a fully accepted Buffer is stored without copying
+    //! \returns the number of bytes accepted into the stream
+    size_t write(const Buffer &data);
+
+    //! \brief Write each Buffer of a BufferList in order, stopping at the first partial write
+    //! \returns the number of bytes accepted into the stream
+    size_t write(const BufferList &data);
+
+    //! \brief Read up to `limit` bytes from `fd` straight into the stream's storage
+    //! \details In Mode::Ring this is a single [readv(2)](\ref man2::readv) into the (up to two) free spans.
+    //! \returns the number of bytes read; `fd.eof()` is set if the fd is at EOF
+    size_t read_from_fd(FileDescriptor &fd, const size_t limit);
 
     //! \returns the number of additional bytes that the stream has space for
     size_t remaining_capacity() const;
@@ -39,9 +75,39 @@ class ByteStream {
     //! \returns a string
     std::string peek_output(const size_t len) const;
 
+    //! \brief Copy (up to) the first `len` bytes into caller-supplied storage, without removing them
+    //! \returns the number of bytes copied
+    size_t peek_into(char *dst, const size_t len) const;
+
+    //! \brief Copy (up to) the first `len` bytes into caller-supplied storage and remove them
+    //! \returns the number of bytes copied
+    size_t read_into(char *dst, const size_t len) {
+        const size_t ret = peek_into(dst, len);
+        pop_output(ret);
+        return ret;
+    }
+
+    //! \returns the buffered bytes as (up to) two contiguous regions, in order; the second may be empty
+    //! \note In Mode::Chunked these are the first two chunks, so they may not cover the whole buffer.
+    //! The views are invalidated by the next write() or pop_output().
+    std::pair<std::string_view, std::string_view> peek_spans() const;
+
+    //! \returns views of (up to) the first `len` bytes of the stream, without copying them
+    //! \note The views are invalidated by the next write() or pop_output()
+    BufferViewList peek_buffers(const size_t len) const;
+
     // Remove bytes from the buffer
     void pop_output(const size_t len);
 
+    //! \brief Write up to `limit` buffered bytes to `fd` with one [writev(2)](\ref man2::writev), then pop them
+    //! \returns the number of bytes written (may be short if `fd` is non-blocking)
+    size_t write_to_fd(FileDescriptor &fd, const size_t limit);
+
+    //! \brief Remove (up to) the first `len` bytes and return them as a Buffer
+    //! \details In Mode::Chunked, bytes that lie in a single chunk are returned as a slice of it without copying;
+    //! otherwise they are copied once into a new Buffer.
+    Buffer read_buffer(const size_t len);
+
     //! \returns a vector of bytes read
     std::string read(const size_t len) {
         const auto ret = peek_output(len);
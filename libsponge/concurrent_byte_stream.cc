@@ -0,0 +1,99 @@
+#include "concurrent_byte_stream.hh"
+
+#include "util.hh"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+/*
+单生产者/单消费者字节流。
+写线程：先把数据 memcpy 进环形缓冲区，再用 release 语义更新 _write_count，读线程看到新的计数时一定能看到数据。
+读线程：用 acquire 读 _write_count，复制数据后再用 release 语义更新 _read_count，把空间还给写线程。
+两端各自只修改自己的计数，因此不需要锁，也不需要 CAS。
+*/
+
+using namespace std;
+
+ConcurrentByteStream::ConcurrentByteStream(const size_t capacity, const bool use_eventfd)
+    : _buffer(round_up_pow2(capacity)), _mask(_buffer.size() - 1), _capacity(capacity) {
+    if (use_eventfd) {
+        _readable_event.emplace(SystemCall("eventfd", ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)));
+        _writable_event.emplace(SystemCall("eventfd", ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)));
+    }
+}
+
+// eventfd 的计数器加一；计数器已满（EAGAIN）时说明对方还没处理之前的通知，可以忽略
+void ConcurrentByteStream::signal(optional<FileDescriptor> &event) {
+    if (!event.has_value()) {
+        return;
+    }
+    const uint64_t one = 1;
+    SystemCall("write", ::write(event->fd_num(), &one, sizeof(one)), EAGAIN);
+}
+
+void ConcurrentByteStream::clear_event(FileDescriptor &event) { event.read(sizeof(uint64_t)); }
+
+// 写线程：写入能放下的前缀
+size_t ConcurrentByteStream::write(const string &data) {
+    const size_t write_count = _write_count.load(memory_order_relaxed);
+    const size_t len = min(data.size(), remaining_capacity());
+    if (len == 0) {
+        return 0;
+    }
+    const size_t tail = write_count & _mask;
+    const size_t first = min(len, _buffer.size() - tail);
+    memcpy(_buffer.data() + tail, data.data(), first);
+    memcpy(_buffer.data(), data.data() + first, len - first);
+    // 数据写完之后再发布新的写计数
+    _write_count.store(write_count + len, memory_order_release);
+    signal(_readable_event);
+    return len;
+}
+
+size_t ConcurrentByteStream::remaining_capacity() const { return _capacity - buffer_size(); }
+
+void ConcurrentByteStream::end_input() {
+    _input_ended_flag.store(true, memory_order_release);
+    signal(_readable_event);
+}
+
+void ConcurrentByteStream::set_error() {
+    _error.store(true, memory_order_release);
+    signal(_readable_event);
+    signal(_writable_event);
+}
+
+// 读线程：复制开头的 len 个字节（最多两段）
+string ConcurrentByteStream::peek_output(const size_t len) const {
+    const size_t read_count = _read_count.load(memory_order_relaxed);
+    const size_t length = min(len, _write_count.load(memory_order_acquire) - read_count);
+    string ret(length, '\0');
+    const size_t head = read_count & _mask;
+    const size_t first = min(length, _buffer.size() - head);
+    memcpy(ret.data(), _buffer.data() + head, first);
+    memcpy(ret.data() + first, _buffer.data(), length - first);
+    return ret;
+}
+
+// 读线程：移动读位置，把空间还给写线程
+void ConcurrentByteStream::pop_output(const size_t len) {
+    const size_t read_count = _read_count.load(memory_order_relaxed);
+    const size_t length = min(len, _write_count.load(memory_order_acquire) - read_count);
+    if (length == 0) {
+        return;
+    }
+    _read_count.store(read_count + length, memory_order_release);
+    signal(_writable_event);
+}
+
+// 先读 input_ended 再读缓冲区大小：写线程是先写完数据再标记结束的
+bool ConcurrentByteStream::eof() const { return input_ended() && buffer_empty(); }
+
+size_t ConcurrentByteStream::buffer_size() const {
+    // 先读 _read_count 再读 _write_count，结果不会为负；在写线程中调用时只可能偏大（剩余空间偏小），不会越界
+    const size_t read_count = _read_count.load(memory_order_acquire);
+    return _write_count.load(memory_order_acquire) - read_count;
+}
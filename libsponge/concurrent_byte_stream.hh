@@ -0,0 +1,111 @@
+#ifndef SPONGE_LIBSPONGE_CONCURRENT_BYTE_STREAM_HH
+#define SPONGE_LIBSPONGE_CONCURRENT_BYTE_STREAM_HH
+
+#include "file_descriptor.hh"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+//! \brief 与 ByteStream 接口相同、可以在两个线程之间共享的字节流
+//!
+//! 只允许一个写线程（调用 write / end_input）和一个读线程（调用 peek_output / pop_output / read）。
+//! 两端通过原子的读写计数同步，不需要加锁；数据放在预分配的环形缓冲区里，只复制一次。
+//! 如果构造时打开了 eventfd，写端在有新数据（或 EOF/错误）时通知 readable_event()，
+//! 读端在腾出空间时通知 writable_event()，方便两端各自在 EventLoop 中等待。
+class ConcurrentByteStream {
+  private:
+    // 环形缓冲区，大小为不小于 capacity 的 2 的幂
+    std::vector<char> _buffer = {};
+    size_t _mask = 0;
+    size_t _capacity = 0;
+    // 只由写线程修改，读线程用 acquire 读取
+    std::atomic<size_t> _write_count{0};
+    // 只由读线程修改，写线程用 acquire 读取
+    std::atomic<size_t> _read_count{0};
+    std::atomic<bool> _input_ended_flag{false};
+    std::atomic<bool> _error{false};
+
+    std::optional<FileDescriptor> _readable_event{};
+    std::optional<FileDescriptor> _writable_event{};
+
+    //! 唤醒在 `event` 上等待的另一端
+    static void signal(std::optional<FileDescriptor> &event);
+
+  public:
+    //! 构造一个容量为 `capacity` 的字节流；`use_eventfd` 为 true 时创建两个用于唤醒的 eventfd
+    ConcurrentByteStream(const size_t capacity, const bool use_eventfd = false);
+
+    //! \name 写线程调用
+    //!@{
+
+    //! \returns the number of bytes accepted into the stream
+    size_t write(const std::string &data);
+
+    //! \returns the number of additional bytes that the stream has space for
+    size_t remaining_capacity() const;
+
+    //! Signal that the byte stream has reached its ending
+    void end_input();
+    //!@}
+
+    //! Indicate that the stream suffered an error (either thread)
+    void set_error();
+
+    //! \name 读线程调用
+    //!@{
+
+    //! \returns a copy of (up to) the first `len` bytes
+    std::string peek_output(const size_t len) const;
+
+    //! Remove bytes from the buffer
+    void pop_output(const size_t len);
+
+    //! \returns (up to) the first `len` bytes, removed from the stream
+    //! \note Pops exactly what was peeked: more bytes may have arrived from the writer in between
+    std::string read(const size_t len) {
+        const auto ret = peek_output(len);
+        pop_output(ret.size());
+        return ret;
+    }
+
+    //! \returns `true` if the output has reached the ending
+    bool eof() const;
+    //!@}
+
+    //! \returns `true` if the stream input has ended
+    bool input_ended() const { return _input_ended_flag.load(std::memory_order_acquire); }
+
+    //! \returns `true` if the stream has suffered an error
+    bool error() const { return _error.load(std::memory_order_acquire); }
+
+    //! \returns the maximum amount that can currently be read from the stream
+    size_t buffer_size() const;
+
+    //! \returns `true` if the buffer is empty
+    bool buffer_empty() const { return buffer_size() == 0; }
+
+    //! Total number of bytes written
+    size_t bytes_written() const { return _write_count.load(std::memory_order_acquire); }
+
+    //! Total number of bytes popped
+    size_t bytes_read() const { return _read_count.load(std::memory_order_acquire); }
+
+    //! \name 唤醒用的 eventfd（仅在构造时打开了 eventfd 时可用）
+    //!@{
+
+    //! eventfd signalled by the writer when bytes, EOF or an error become visible to the reader
+    FileDescriptor &readable_event() { return _readable_event.value(); }
+
+    //! eventfd signalled by the reader when space is freed for the writer
+    FileDescriptor &writable_event() { return _writable_event.value(); }
+
+    //! Consume the pending notification on an eventfd that polled readable
+    static void clear_event(FileDescriptor &event);
+    //!@}
+};
+
+#endif  // SPONGE_LIBSPONGE_CONCURRENT_BYTE_STREAM_HH
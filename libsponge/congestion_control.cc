@@ -0,0 +1,365 @@
+#include "congestion_control.hh"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+// 默认不关心发送和快速恢复期间的重复确认
+void CongestionControl::on_send(const uint64_t, const size_t, const size_t) {}
+
+void CongestionControl::on_dup_ack(const uint64_t, const size_t) {}
+
+optional<double> CongestionControl::pacing_rate() const { return nullopt; }
+
+bool CongestionControl::in_slow_start() const { return false; }
+
+void CongestionControl::set_mss(const size_t) {}
+
+NewReno::NewReno(const size_t mss) : _mss(mss), _cwnd(10 * mss) {}
+
+void NewReno::on_ack(const AckEvent &ack) {
+    if (ack.exits_recovery) {
+        // 完整确认：窗口回落到 ssthresh，结束快速恢复
+        _in_recovery = false;
+        _cwnd = _ssthresh;
+        _bytes_acked = 0;
+        return;
+    }
+    if (ack.partial_ack && ack.sack_recovery) {
+        // SACK 恢复期间窗口保持在 ssthresh（RFC 6675）
+        _cwnd = max(_ssthresh, _mss);
+        return;
+    }
+    if (ack.partial_ack) {
+        // 部分确认：扣掉新确认的字节（膨胀部分随之收回），如果确认了至少一个 MSS 再加回一个 MSS
+        _cwnd = _cwnd > ack.acked_bytes ? _cwnd - ack.acked_bytes : 0;
+        if (ack.acked_bytes >= _mss) {
+            _cwnd += _mss;
+        }
+        _cwnd = max(_cwnd, _mss);
+        return;
+    }
+    if (_cwnd < _ssthresh) {
+        // 慢启动：每次确认最多增加 2 个 MSS（RFC 3465，L = 2）
+        _cwnd += min(ack.acked_bytes, 2 * _mss);
+        return;
+    }
+    congestion_avoidance(ack);
+}
+
+// 拥塞避免：每确认一个 cwnd 的数据，窗口增加一个 MSS
+void NewReno::congestion_avoidance(const AckEvent &ack) {
+    _bytes_acked += ack.acked_bytes;
+    if (_bytes_acked >= _cwnd) {
+        _bytes_acked -= _cwnd;
+        _cwnd += _mss;
+    }
+}
+
+// 快速恢复期间每个重复确认代表有一个段离开了网络，窗口膨胀一个 MSS
+void NewReno::on_dup_ack(const uint64_t, const size_t) {
+    if (_in_recovery) {
+        _cwnd += _mss;
+    }
+}
+
+size_t NewReno::congestion_event(const uint64_t, const size_t bytes_in_flight) {
+    return max(bytes_in_flight / 2, 2 * _mss);
+}
+
+void NewReno::on_loss(const uint64_t now, const size_t bytes_in_flight) {
+    _ssthresh = congestion_event(now, bytes_in_flight);
+    _cwnd = _ssthresh + 3 * _mss;
+    _bytes_acked = 0;
+    _in_recovery = true;
+}
+
+// 超时之后从一个 MSS 重新慢启动
+void NewReno::on_rto(const uint64_t now, const size_t bytes_in_flight) {
+    _ssthresh = congestion_event(now, bytes_in_flight);
+    _cwnd = _mss;
+    _bytes_acked = 0;
+    _in_recovery = false;
+}
+
+void Cubic::on_ack(const AckEvent &ack) {
+    if (ack.rtt.has_value() && (_min_rtt == 0 || *ack.rtt < _min_rtt)) {
+        _min_rtt = max<uint64_t>(*ack.rtt, 1);
+    }
+    NewReno::on_ack(ack);
+}
+
+// 以 MSS 为单位计算，时间以秒计
+void Cubic::congestion_avoidance(const AckEvent &ack) {
+    const double cwnd = double(_cwnd) / _mss;
+    if (!_epoch_start.has_value()) {
+        // 新一轮增长：从当前窗口出发，K 秒后回到 W_max
+        _epoch_start = ack.now;
+        if (cwnd < _w_max) {
+            _k = cbrt((_w_max - cwnd) / C);
+        } else {
+            _k = 0;
+            _w_max = cwnd;
+        }
+    }
+    // 还没有 RTT 样本时按 100 毫秒估计
+    const double rtt = (_min_rtt == 0 ? 100 : _min_rtt) / 1000.0;
+    const double t = (ack.now - *_epoch_start) / 1000.0;
+    const double acked = double(ack.acked_bytes) / _mss;
+
+    // 同样时间内 Reno 能达到的窗口（RFC 8312 式 4），CUBIC 不低于它
+    const double w_est = _w_max * BETA + 3 * (1 - BETA) / (1 + BETA) * (t / rtt);
+    const double w_cubic = C * pow(t - _k, 3) + _w_max;
+    double target;
+    if (w_cubic < w_est) {
+        target = w_est;
+    } else {
+        // 以一个 RTT 之后的目标窗口为准，每确认一个 MSS 增长 (target - cwnd) / cwnd
+        target = C * pow(t + rtt - _k, 3) + _w_max;
+    }
+    if (target > cwnd) {
+        _carry += (target - cwnd) / cwnd * acked * _mss;
+        _cwnd += static_cast<size_t>(_carry);
+        _carry -= floor(_carry);
+    }
+}
+
+size_t Cubic::congestion_event(const uint64_t, const size_t) {
+    const double cwnd = double(_cwnd) / _mss;
+    // 快速收敛：这次拥塞时的窗口比上次小，说明有新流加入，多让出一些
+    if (cwnd < _w_last_max) {
+        _w_last_max = cwnd;
+        _w_max = cwnd * (1 + BETA) / 2;
+    } else {
+        _w_last_max = cwnd;
+        _w_max = cwnd;
+    }
+    _epoch_start.reset();
+    _carry = 0;
+    return max(static_cast<size_t>(_cwnd * BETA), 2 * _mss);
+}
+
+BBR::BBR(const size_t mss, const unsigned seed) : _mss(mss), _cwnd(10 * mss), _rng(seed) {}
+
+// 还没有带宽和 RTT 样本时按初始窗口估计
+size_t BBR::bdp(const double gain) const {
+    if (!_min_rtt.has_value() || _bw_filter.empty()) {
+        return 10 * _mss;
+    }
+    return static_cast<size_t>(gain * bottleneck_bandwidth() * max<uint64_t>(*_min_rtt, 1));
+}
+
+void BBR::on_ack(const AckEvent &ack) {
+    update_round(ack);
+    update_bw(ack);
+    update_cycle_phase(ack);
+    check_full_pipe(ack);
+    check_drain(ack);
+    update_min_rtt(ack);
+
+    // 管道填满之前 pacing 速率只升不降，避免一个偏低的样本拖慢 Startup
+    const double bw = bottleneck_bandwidth();
+    if (bw > 0 && (_filled_pipe || _pacing_gain * bw > _pacing_rate)) {
+        _pacing_rate = _pacing_gain * bw;
+    }
+    set_cwnd(ack);
+}
+
+// 最新确认的段是在本轮开始之后发出的，说明过了一个往返
+void BBR::update_round(const AckEvent &ack) {
+    _round_start = false;
+    if (ack.acked_bytes > 0 && ack.prior_delivered >= _next_round_delivered) {
+        _next_round_delivered = ack.delivered;
+        ++_round;
+        _round_start = true;
+    }
+}
+
+// 受应用限制的样本只在不低于当前估计时才采用
+void BBR::update_bw(const AckEvent &ack) {
+    while (!_bw_filter.empty() && _bw_filter.front().first + BW_WINDOW_ROUNDS <= _round) {
+        _bw_filter.pop_front();
+    }
+    if (!ack.delivery_rate.has_value()) {
+        return;
+    }
+    const double rate = *ack.delivery_rate;
+    if (ack.app_limited && rate < bottleneck_bandwidth()) {
+        return;
+    }
+    while (!_bw_filter.empty() && _bw_filter.back().second <= rate) {
+        _bw_filter.pop_back();
+    }
+    _bw_filter.emplace_back(_round, rate);
+}
+
+// ProbeBW 每个 RTprop 换一相；1.25 相要等到在途数据真的多出 25%（或发生丢包），0.75 相在途数据降到 BDP 即可提前结束
+void BBR::update_cycle_phase(const AckEvent &ack) {
+    if (_mode != Mode::ProbeBW) {
+        return;
+    }
+    const size_t prior_in_flight = ack.bytes_in_flight + ack.acked_bytes;
+    const bool full_length = ack.now - _cycle_stamp > _min_rtt.value_or(0);
+    bool next = full_length;
+    if (_pacing_gain > 1) {
+        next = full_length && (_in_recovery || prior_in_flight >= bdp(_pacing_gain));
+    } else if (_pacing_gain < 1) {
+        next = full_length || prior_in_flight <= bdp(1);
+    }
+    if (next) {
+        _cycle_index = (_cycle_index + 1) % CYCLE_LENGTH;
+        _cycle_stamp = ack.now;
+        _pacing_gain = PACING_GAINS[_cycle_index];
+    }
+}
+
+// 带宽估计连续三轮增长不到 25%，认为已经填满瓶颈
+void BBR::check_full_pipe(const AckEvent &ack) {
+    if (_filled_pipe || !_round_start || ack.app_limited) {
+        return;
+    }
+    const double bw = bottleneck_bandwidth();
+    if (bw >= _full_bw * 1.25) {
+        _full_bw = bw;
+        _full_bw_rounds = 0;
+        return;
+    }
+    if (++_full_bw_rounds >= 3) {
+        _filled_pipe = true;
+    }
+}
+
+void BBR::check_drain(const AckEvent &ack) {
+    if (_mode == Mode::Startup && _filled_pipe) {
+        _mode = Mode::Drain;
+        _pacing_gain = 1 / HIGH_GAIN;
+        _cwnd_gain = HIGH_GAIN;
+    }
+    if (_mode == Mode::Drain && ack.bytes_in_flight <= bdp(1)) {
+        enter_probe_bw(ack.now);
+    }
+}
+
+// 随机选一相开始（但不从 0.75 开始），避免共享瓶颈的多条流同步探测
+void BBR::enter_probe_bw(const uint64_t now) {
+    _mode = Mode::ProbeBW;
+    _cwnd_gain = CWND_GAIN;
+    _cycle_index = (CYCLE_LENGTH - 1 - _rng() % (CYCLE_LENGTH - 1) + 1) % CYCLE_LENGTH;
+    _cycle_stamp = now;
+    _pacing_gain = PACING_GAINS[_cycle_index];
+}
+
+// RTprop 过期后进入 ProbeRTT，在途数据降到 4 个 MSS 后至少保持 200 毫秒和一轮
+void BBR::update_min_rtt(const AckEvent &ack) {
+    const bool expired = _min_rtt.has_value() && ack.now > _min_rtt_stamp + MIN_RTT_WINDOW;
+    if (ack.rtt.has_value() && (!_min_rtt.has_value() || *ack.rtt <= *_min_rtt || expired)) {
+        _min_rtt = *ack.rtt;
+        _min_rtt_stamp = ack.now;
+    }
+
+    if (expired && _mode != Mode::ProbeRTT) {
+        save_cwnd();
+        _mode = Mode::ProbeRTT;
+        _pacing_gain = 1;
+        _cwnd_gain = 1;
+        _probe_rtt_done.reset();
+    }
+    if (_mode != Mode::ProbeRTT) {
+        return;
+    }
+    if (!_probe_rtt_done.has_value()) {
+        if (ack.bytes_in_flight <= min_cwnd()) {
+            _probe_rtt_done = ack.now + PROBE_RTT_DURATION;
+            _probe_rtt_round_done = false;
+            _next_round_delivered = ack.delivered;
+        }
+        return;
+    }
+    if (_round_start) {
+        _probe_rtt_round_done = true;
+    }
+    if (_probe_rtt_round_done && ack.now >= *_probe_rtt_done) {
+        _min_rtt_stamp = ack.now;
+        exit_probe_rtt(ack.now);
+    }
+}
+
+void BBR::exit_probe_rtt(const uint64_t now) {
+    _cwnd = max(_cwnd, _prior_cwnd);
+    if (_filled_pipe) {
+        enter_probe_bw(now);
+    } else {
+        _mode = Mode::Startup;
+        _pacing_gain = HIGH_GAIN;
+        _cwnd_gain = HIGH_GAIN;
+    }
+}
+
+// cwnd 的目标是 cwnd_gain * BDP 再加 3 个 MSS，给延迟确认和聚合留余量
+void BBR::set_cwnd(const AckEvent &ack) {
+    if (ack.exits_recovery) {
+        _in_recovery = false;
+        _cwnd = max(_cwnd, _prior_cwnd);
+    }
+    const size_t target = bdp(_cwnd_gain) + 3 * _mss;
+    if (_in_recovery && _round < _conservation_round) {
+        // 包守恒：确认了多少就再发多少
+        _cwnd = max(_cwnd, ack.bytes_in_flight + ack.acked_bytes);
+    } else if (_filled_pipe) {
+        _cwnd = min(_cwnd + ack.acked_bytes, target);
+    } else if (_cwnd < target || ack.delivered < 10 * _mss) {
+        _cwnd += ack.acked_bytes;
+    }
+    _cwnd = max(_cwnd, min_cwnd());
+    if (_mode == Mode::ProbeRTT) {
+        _cwnd = min(_cwnd, min_cwnd());
+    }
+}
+
+// 恢复或 ProbeRTT 期间 cwnd 已经被压低，记住之前较大的那个
+void BBR::save_cwnd() {
+    _prior_cwnd = _in_recovery || _mode == Mode::ProbeRTT ? max(_prior_cwnd, _cwnd) : _cwnd;
+}
+
+// 快速恢复期间每个重复确认代表有一个段离开了网络，允许再发一个
+void BBR::on_dup_ack(const uint64_t, const size_t bytes_in_flight) {
+    if (_in_recovery) {
+        _cwnd = max(_cwnd, bytes_in_flight + _mss);
+    }
+}
+
+// 丢包不改变带宽模型，只在第一轮按包守恒发送
+void BBR::on_loss(const uint64_t, const size_t bytes_in_flight) {
+    save_cwnd();
+    _in_recovery = true;
+    _conservation_round = _round + 1;
+    _cwnd = max(bytes_in_flight, min_cwnd());
+}
+
+void BBR::on_rto(const uint64_t, const size_t) {
+    save_cwnd();
+    _in_recovery = false;
+    _cwnd = _mss;
+}
+
+optional<double> BBR::pacing_rate() const {
+    if (_pacing_rate > 0) {
+        return _pacing_rate;
+    }
+    return nullopt;
+}
+
+unique_ptr<CongestionControl> make_congestion_control(const CongestionControlAlgorithm algorithm, const size_t mss) {
+    switch (algorithm) {
+        case CongestionControlAlgorithm::NewReno:
+            return make_unique<NewReno>(mss);
+        case CongestionControlAlgorithm::Cubic:
+            return make_unique<Cubic>(mss);
+        case CongestionControlAlgorithm::BBR:
+            return make_unique<BBR>(mss);
+        case CongestionControlAlgorithm::None:
+            break;
+    }
+    return nullptr;
+}
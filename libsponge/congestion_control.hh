@@ -0,0 +1,228 @@
+#ifndef SPONGE_LIBSPONGE_CONGESTION_CONTROL_HH
+#define SPONGE_LIBSPONGE_CONGESTION_CONTROL_HH
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <random>
+#include <utility>
+
+//! TCPSender 可选的拥塞控制算法
+enum class CongestionControlAlgorithm {
+    None,     //!< 不做拥塞控制，只受接收方窗口限制
+    NewReno,  //!< 慢启动、拥塞避免和快速恢复（RFC 5681 / RFC 6582）
+    Cubic,    //!< 按距上次拥塞的时间做三次函数增长（RFC 8312），慢启动和快速恢复同 NewReno
+    BBR       //!< 按测得的瓶颈带宽和最小 RTT 控制发送速率（BBR v1），不以丢包为拥塞信号
+};
+
+//! 一次推进了累积确认号的 ACK
+struct AckEvent {
+    uint64_t now = 0;              //!< 发送方时钟（毫秒，由 tick 累加）
+    size_t acked_bytes = 0;        //!< 本次新确认的字节数（按序列号空间计）
+    size_t bytes_in_flight = 0;    //!< 处理完本次确认后仍在传输中的字节数（有 SACK 时为 RFC 6675 的 pipe）
+    bool partial_ack = false;      //!< 快速恢复期间的部分确认（没有确认到恢复点）
+    bool exits_recovery = false;   //!< 本次确认越过了恢复点，快速恢复结束
+    bool sack_recovery = false;    //!< 快速恢复按 SACK 记分板进行，发送量由 pipe 控制，窗口不需要膨胀和收缩
+    std::optional<uint64_t> rtt{}; //!< 本次确认得到的 RTT 样本（毫秒），没有时间戳时重传过的段不采样（Karn）
+
+    uint64_t delivered = 0;        //!< 到本次确认为止累计交付的字节数
+    uint64_t prior_delivered = 0;  //!< 本次确认的最新一段发送时的累计交付字节数
+    std::optional<double> delivery_rate{};  //!< 交付速率样本（字节/毫秒），最新一段重传过则没有
+    bool app_limited = false;      //!< 样本测得时发送方曾因没有数据可发而空闲，速率可能偏低
+};
+
+//! \brief 拥塞控制算法的接口
+//!
+//! TCPSender 在发送、确认、重复确认、丢包和超时时调用对应的钩子，
+//! 并用 min(cwnd(), 接收方窗口) 作为实际的发送窗口。
+class CongestionControl {
+  public:
+    virtual ~CongestionControl() = default;
+
+    //! 发送了 `bytes` 字节的新数据（不包括重传），`bytes_in_flight` 已包含这些字节
+    virtual void on_send(const uint64_t now, const size_t bytes, const size_t bytes_in_flight);
+
+    //! 收到推进了累积确认号的 ACK
+    virtual void on_ack(const AckEvent &ack) = 0;
+
+    //! 快速恢复期间又收到一个重复确认
+    virtual void on_dup_ack(const uint64_t now, const size_t bytes_in_flight);
+
+    //! 三个重复确认判定丢包，发送方已经快速重传并进入快速恢复
+    virtual void on_loss(const uint64_t now, const size_t bytes_in_flight) = 0;
+
+    //! 重传定时器超时
+    virtual void on_rto(const uint64_t now, const size_t bytes_in_flight) = 0;
+
+    //! 当前的拥塞窗口（字节）
+    virtual size_t cwnd() const = 0;
+
+    //! 发送速率（字节/毫秒），为空表示不做 pacing，只受窗口限制
+    virtual std::optional<double> pacing_rate() const;
+
+    //! 是否处于慢启动，发送方按窗口估计 pacing 速率时用来选择增益
+    virtual bool in_slow_start() const;
+
+    //! 路径 MTU 探测改变了 MSS：窗口保持字节数不变，只改变按 MSS 计的增长量和下限
+    virtual void set_mss(const size_t mss);
+};
+
+//! \brief NewReno：慢启动、拥塞避免（按确认字节数计数）和 NewReno 快速恢复
+//!
+//! 派生类可以替换拥塞避免阶段的增长方式和拥塞时的窗口缩减，复用慢启动和快速恢复。
+class NewReno : public CongestionControl {
+  protected:
+    size_t _mss;
+    size_t _cwnd;
+    size_t _ssthresh = SIZE_MAX;
+    size_t _bytes_acked = 0;  // 拥塞避免阶段累计的确认字节数，每满一个 cwnd 窗口增加一个 MSS
+    bool _in_recovery = false;
+
+    //! 拥塞避免阶段收到一个确认
+    virtual void congestion_avoidance(const AckEvent &ack);
+
+    //! 发生拥塞（丢包或超时），返回新的 ssthresh
+    virtual size_t congestion_event(const uint64_t now, const size_t bytes_in_flight);
+
+  public:
+    //! 初始窗口为 10 个 MSS（RFC 6928）
+    explicit NewReno(const size_t mss);
+
+    void on_ack(const AckEvent &ack) override;
+    void on_dup_ack(const uint64_t now, const size_t bytes_in_flight) override;
+    void on_loss(const uint64_t now, const size_t bytes_in_flight) override;
+    void on_rto(const uint64_t now, const size_t bytes_in_flight) override;
+    size_t cwnd() const override { return _cwnd; }
+    bool in_slow_start() const override { return _cwnd < _ssthresh; }
+    void set_mss(const size_t mss) override { _mss = mss; }
+
+    size_t ssthresh() const { return _ssthresh; }
+};
+
+//! \brief CUBIC（RFC 8312）
+//!
+//! 拥塞避免阶段窗口为 W(t) = C(t - K)^3 + W_max，t 是距本轮拥塞事件的时间，
+//! 在 W_max 附近增长平缓、远离时增长迅速；同时不低于同样条件下 Reno 能达到的窗口（TCP 友好区）。
+//! 拥塞时窗口乘以 beta = 0.7，并在连续两次拥塞的 W_max 下降时提前让出带宽（快速收敛）。
+class Cubic : public NewReno {
+  private:
+    static constexpr double C = 0.4;
+    static constexpr double BETA = 0.7;
+
+    double _w_max = 0;       // 最近一次拥塞前的窗口（MSS 个数）
+    double _w_last_max = 0;  // 再上一次拥塞前的窗口，用于快速收敛
+    double _k = 0;           // 窗口回到 W_max 所需的时间（秒）
+    std::optional<uint64_t> _epoch_start{};  // 本轮拥塞避免开始的时间，拥塞后清空
+    uint64_t _min_rtt = 0;   // 观察到的最小 RTT（毫秒），0 表示还没有样本
+    double _carry = 0;       // 不足一个字节的窗口增长，累计到下次
+
+  protected:
+    void congestion_avoidance(const AckEvent &ack) override;
+    size_t congestion_event(const uint64_t now, const size_t bytes_in_flight) override;
+
+  public:
+    explicit Cubic(const size_t mss) : NewReno(mss) {}
+
+    //! 记录最小 RTT 后按 NewReno 处理
+    void on_ack(const AckEvent &ack) override;
+
+    //! 最近一次拥塞前的窗口（字节）
+    size_t w_max() const { return static_cast<size_t>(_w_max * _mss); }
+};
+
+//! \brief BBR v1：基于瓶颈带宽和往返传播时间模型的拥塞控制
+//!
+//! 每个确认得到一个交付速率样本，取最近 10 轮中的最大值作为瓶颈带宽 BtlBw，取 10 秒内的最小 RTT 作为 RTprop，
+//! 以 pacing_gain * BtlBw 的速率发送，cwnd 限制为 cwnd_gain * BDP。状态依次为：
+//! Startup（以 2/ln2 的增益指数探测，带宽连续 3 轮增长不到 25% 时认为管道已满）、
+//! Drain（排空 Startup 造成的排队）、ProbeBW（增益在 1.25、0.75 和 6 个 1 之间循环）
+//! 以及 ProbeRTT（RTprop 10 秒未更新时把 cwnd 降到 4 个 MSS 保持 200 毫秒，重新测量最小 RTT）。
+class BBR : public CongestionControl {
+  public:
+    enum class Mode { Startup, Drain, ProbeBW, ProbeRTT };
+
+  private:
+    static constexpr double HIGH_GAIN = 2.885;  // 2/ln2，每轮发送速率翻倍所需的最小增益
+    static constexpr double CWND_GAIN = 2;
+    static constexpr size_t CYCLE_LENGTH = 8;
+    static constexpr double PACING_GAINS[CYCLE_LENGTH] = {1.25, 0.75, 1, 1, 1, 1, 1, 1};
+    static constexpr uint64_t BW_WINDOW_ROUNDS = 10;
+    static constexpr uint64_t MIN_RTT_WINDOW = 10000;     // 毫秒
+    static constexpr uint64_t PROBE_RTT_DURATION = 200;  // 毫秒
+
+    size_t _mss;
+    size_t _cwnd;
+    Mode _mode = Mode::Startup;
+    double _pacing_gain = HIGH_GAIN;
+    double _cwnd_gain = HIGH_GAIN;
+    double _pacing_rate = 0;
+
+    // 瓶颈带宽的窗口最大值过滤器：(轮次, 速率)，速率单调递减
+    std::deque<std::pair<uint64_t, double>> _bw_filter{};
+    std::optional<uint64_t> _min_rtt{};
+    uint64_t _min_rtt_stamp = 0;
+
+    // 轮次：发送时累计交付量达到 _next_round_delivered 的段被确认，就开始新的一轮
+    uint64_t _round = 0;
+    uint64_t _next_round_delivered = 0;
+    bool _round_start = false;
+
+    // Startup 阶段的满管道检测
+    double _full_bw = 0;
+    size_t _full_bw_rounds = 0;
+    bool _filled_pipe = false;
+
+    // ProbeBW 增益循环
+    size_t _cycle_index = 0;
+    uint64_t _cycle_stamp = 0;
+    std::minstd_rand _rng;
+
+    // ProbeRTT 的结束时间和是否已经过了一轮
+    std::optional<uint64_t> _probe_rtt_done{};
+    bool _probe_rtt_round_done = false;
+
+    // 丢包恢复：第一轮按包守恒，结束后恢复进入恢复前的窗口
+    size_t _prior_cwnd = 0;
+    bool _in_recovery = false;
+    uint64_t _conservation_round = 0;
+
+    size_t min_cwnd() const { return 4 * _mss; }
+    size_t bdp(const double gain) const;
+    void update_round(const AckEvent &ack);
+    void update_bw(const AckEvent &ack);
+    void update_cycle_phase(const AckEvent &ack);
+    void check_full_pipe(const AckEvent &ack);
+    void check_drain(const AckEvent &ack);
+    void update_min_rtt(const AckEvent &ack);
+    void enter_probe_bw(const uint64_t now);
+    void exit_probe_rtt(const uint64_t now);
+    void set_cwnd(const AckEvent &ack);
+    void save_cwnd();
+
+  public:
+    //! 初始窗口为 10 个 MSS，`seed` 决定进入 ProbeBW 时从增益循环的哪一相开始
+    explicit BBR(const size_t mss, const unsigned seed = std::random_device()());
+
+    void on_ack(const AckEvent &ack) override;
+    void on_dup_ack(const uint64_t now, const size_t bytes_in_flight) override;
+    void on_loss(const uint64_t now, const size_t bytes_in_flight) override;
+    void on_rto(const uint64_t now, const size_t bytes_in_flight) override;
+    size_t cwnd() const override { return _cwnd; }
+    std::optional<double> pacing_rate() const override;
+    void set_mss(const size_t mss) override { _mss = mss; }
+
+    Mode mode() const { return _mode; }
+    //! 瓶颈带宽估计（字节/毫秒）
+    double bottleneck_bandwidth() const { return _bw_filter.empty() ? 0 : _bw_filter.front().second; }
+    //! 往返传播时间估计（毫秒）
+    std::optional<uint64_t> min_rtt() const { return _min_rtt; }
+    double pacing_gain() const { return _pacing_gain; }
+};
+
+//! 按算法创建拥塞控制模块；`None` 返回空指针
+std::unique_ptr<CongestionControl> make_congestion_control(const CongestionControlAlgorithm algorithm,
+                                                           const size_t mss);
+
+#endif  // SPONGE_LIBSPONGE_CONGESTION_CONTROL_HH
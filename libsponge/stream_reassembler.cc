@@ -1,5 +1,7 @@
 #include "stream_reassembler.hh"
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 // 流重组器的占位实现。
 // 对于实验 1，请用一个能通过 `make check_lab1` 自动检查的真正实现来替换此代码。
@@ -13,159 +15,254 @@ using namespace std;
 // 构造一个最大容量为 `capacity` 的流重组器。
 // `_output` 是内部的字节流，其容量也被设置为 `capacity`，用于存储重组后的有序字节流。
 // `_capacity` 存储了该流重组器允许处理的最大字节数。
-StreamReassembler::StreamReassembler(const size_t capacity) 
-    : _output(capacity), _capacity(capacity) // 成员初始化列表
+// Ring 模式在这里一次性分配环形缓冲区和位图，之后收到乱序数据也不会再分配内存
+StreamReassembler::StreamReassembler(const size_t capacity, const Mode mode) 
+    : _mode(mode), _output(capacity), _capacity(capacity) // 成员初始化列表
 {
-    _buffer.resize(capacity);
+    if (_mode == Mode::Ring) {
+        _buffer.resize(capacity);
+        _bitmap.resize((capacity + 63) / 64);
+    }
 }
 
 
 
-/* 尝试合并两个字节块（由 block_node 结构体表示）。
- * 如果这两个字节块存在重叠部分，就将它们合并成一个新的字节块；若不存在重叠部分，则不进行合并操作。
- * 函数最终返回合并过程中被合并掉的字节数量，若无法合并则返回 -1*/
-// 定义 merge_block 函数，用于合并两个字节块
-long StreamReassembler::merge_block(block_node &elm1, const block_node &elm2){
-    block_node x, y;
-    // 比较 elm1 和 elm2 的起始位置，将起始位置较小的字节块赋值给 x，较大的赋值给 y
-    if (elm1.begin > elm2.begin) {
-        x = elm2;
-        y = elm1;
-    } else {
-        x = elm1;
-        y = elm2;
-    }
-    
-    // 情况 1：两个字节块没有重叠部分
-    // 判断 x 字节块的结束位置（起始位置 + 长度）是否小于 y 字节块的起始位置
-    if (x.begin + x.length < y.begin) {
-        return -1;
-    } 
-    // 情况 2：x 字节块完全包含 y 字节块
-    // 判断 x 字节块的结束位置是否大于等于 y 字节块的结束位置
-    else if (x.begin + x.length >= y.begin + y.length) {
-        // 将合并结果（即 x 字节块）赋值给 elm1
-        elm1 = x;
-        // 返回被合并掉的 y 字节块的长度
-        return y.length;
-    } 
-    // 情况 3：两个字节块部分重叠
-    else {
-        // 合并后的字节块起始位置为 x 字节块的起始位置
-        elm1.begin = x.begin;
-        // 合并后的字节块数据由 x 字节块的数据和 y 字节块中未重叠部分的数据拼接而成
-        elm1.data = x.data + y.data.substr(x.begin + x.length - y.begin);
-        // 更新合并后字节块的长度
-        elm1.length = elm1.data.length();
-        // 返回重叠部分的字节数量
-        return x.begin + x.length - y.begin;
+// 把 data 中落在 [begin, end) 内、尚未被已有块覆盖的字节逐段插入
+// 只会向后遍历新子串覆盖到的那些块，每找到一个空隙就插入一个只包含新字节的块
+void StreamReassembler::insert_new_bytes(const string_view data, const size_t index, size_t begin, const size_t end) {
+    // 第一个起始位置大于 begin 的块
+    auto iter = _blocks.upper_bound(begin);
+    // 前一个块如果覆盖了 begin，就把 begin 挪到它的末尾
+    if (iter != _blocks.begin()) {
+        const auto prev = std::prev(iter);
+        begin = max(begin, prev->first + prev->second.size());
+    }
+    while (begin < end) {
+        // 当前空隙的结束位置：下一个已有块的起点，或者新子串的末尾
+        const size_t gap_end = iter == _blocks.end() ? end : min(end, iter->first);
+        if (begin < gap_end) {
+            // emplace_hint 以 iter 为提示，插入是均摊 O(1) 的
+            _blocks.emplace_hint(iter, begin, string(data.substr(begin - index, gap_end - begin)));
+            _unassembled_byte += gap_end - begin;
+        }
+        if (iter == _blocks.end()) {
+            break;
+        }
+        // 跳过已有块覆盖的部分
+        begin = max(begin, iter->first + iter->second.size());
+        ++iter;
     }
 }
 
-//! \details 此函数接收来自逻辑流的一个子字符串（也称为一个段），该子字符串可能是乱序的。
-//! 它会将任何新的连续子字符串进行组装，并按顺序写入输出流中。
-void StreamReassembler::push_substring(const string &data, const size_t index, const bool eof) {
-    // _head_index 表示当前等待组装的第一个字节的索引，_capacity 是缓冲区的容量
-    // 如果起始索引大于等于 _head_index + _capacity，说明该子字符串超出了缓冲区范围，直接返回
-    if(index >= _head_index + _capacity){
-        return;
+// 把从 _head_index 开始连续的块依次写入输出流
+// 所有块都在可接收范围内，因此输出流一定能全部写下
+void StreamReassembler::flush_blocks() {
+    while (!_blocks.empty() && _blocks.begin()->first == _head_index) {
+        const auto head_block = _blocks.begin();
+        const size_t write_bytes = _output.write(head_block->second);
+        _head_index += write_bytes;
+        _unassembled_byte -= write_bytes;
+        _blocks.erase(head_block);
+    }
+}
+
+// 一次处理一个 64 位字：用掩码整体置位，并用 popcount 统计之前没有到达过的字节数
+size_t StreamReassembler::set_bits(size_t pos, size_t len) {
+    size_t newly_set = 0;
+    while (len > 0) {
+        const size_t bit = pos % 64;
+        const size_t n = min(len, 64 - bit);
+        const uint64_t mask = (n == 64 ? ~uint64_t{0} : (uint64_t{1} << n) - 1) << bit;
+        newly_set += __builtin_popcountll(mask & ~_bitmap[pos / 64]);
+        _bitmap[pos / 64] |= mask;
+        pos += n;
+        len -= n;
     }
+    return newly_set;
+}
 
-    block_node elm;
-
-    // 情况 1：子字符串完全在已处理范围之前
-    // 如果子字符串的结束索引（index + data.length()）小于等于 _head_index，说明该子字符串已经处理过了
-    if(index + data.length() <= _head_index){
-        // 跳转到 JUDGE_EOF 标签处，检查 EOF 标志
-        goto JUDGE_EOF;
-    }
-    // 情况 2：子字符串部分在已处理范围之前
-    else if(index < _head_index){
-        // 计算子字符串中需要跳过的字节数
-        size_t offset = _head_index - index;
-        // 截取子字符串中从 _head_index 开始的部分
-        elm.data.assign(data.begin() + offset, data.end());
-        // 更新子字符串的起始索引
-        elm.begin = index + offset;
-        // 更新子字符串的长度
-        elm.length = elm.data.length();
-    }
-    // 情况 3：子字符串完全在未处理范围
-    else{
-        // 直接使用传入的起始索引
-        elm.begin = index;
-        // 直接使用传入的子字符串长度
-        elm.length = data.length();
-        // 直接使用传入的子字符串数据
-        elm.data = data;
-    }
-
-    // 增加未组装的字节数
-    _unassembled_byte += elm.length;
-
-    // 合并重叠的子字符串
-    do{
-        // 初始化合并的字节数为 0
-        long merged_bytes = 0;
-        // 找到第一个起始位置大于等于 elm.begin 的块
-        auto iter = _blocks.lower_bound(elm);
-        // 从当前找到的块开始，向后遍历 _blocks 集合，尝试合并重叠的块
-        while(iter != _blocks.end() && (merged_bytes = merge_block(elm, *iter)) >= 0){
-            // 减少未组装的字节数
-            _unassembled_byte -= merged_bytes;
-            // 从 _blocks 集合中移除已合并的块
-            _blocks.erase(iter);
-            // 重新找到第一个起始位置大于等于 elm.begin 的块
-            iter = _blocks.lower_bound(elm);
+void StreamReassembler::clear_bits(size_t pos, size_t len) {
+    while (len > 0) {
+        const size_t bit = pos % 64;
+        const size_t n = min(len, 64 - bit);
+        const uint64_t mask = (n == 64 ? ~uint64_t{0} : (uint64_t{1} << n) - 1) << bit;
+        _bitmap[pos / 64] &= ~mask;
+        pos += n;
+        len -= n;
+    }
+}
+
+void StreamReassembler::set_limits(const size_t max_bytes, const size_t max_fragments, shared_ptr<SharedBudget> shared) {
+    _max_unassembled_bytes = max_bytes;
+    _max_fragments = max_fragments;
+    _shared_budget.reset(move(shared));
+    enforce_limits();
+}
+
+// 本重组器允许缓存的字节数（和块数）取自身上限和共享预算中剩余部分的较小值
+// 只淘汰还没有连续到达的字节，所以要在写入输出流之后调用
+void StreamReassembler::enforce_limits() {
+    size_t allowed = _max_unassembled_bytes;
+    size_t allowed_fragments = _max_fragments;
+    SharedBudget *shared = _shared_budget.get();
+    if (shared) {
+        const size_t others = shared->used_bytes.load() - _shared_budget.held();
+        allowed = min(allowed, shared->max_bytes > others ? shared->max_bytes - others : 0);
+        const size_t other_fragments = shared->used_fragments.load() - _shared_budget.held_fragments();
+        allowed_fragments = min(allowed_fragments,
+                                shared->max_fragments > other_fragments ? shared->max_fragments - other_fragments : 0);
+    }
+    const size_t before = _unassembled_byte;
+    if (_unassembled_byte > allowed) {
+        if (_mode == Mode::Ring) {
+            evict_ring(_unassembled_byte - allowed);
+        } else {
+            evict_blocks(_unassembled_byte - allowed);
         }
-        // 如果已经到了 _blocks 集合的开头，说明前面没有可合并的块了，跳出循环
-        if(iter == _blocks.begin()){
-            break;
+    }
+    if (_mode == Mode::IntervalMap) {
+        while (_blocks.size() > allowed_fragments) {
+            evict_blocks(prev(_blocks.end())->second.size());
+        }
+    }
+    if (_unassembled_byte < before) {
+        _evicted_bytes += before - _unassembled_byte;
+        ++_evictions;
+        if (shared) {
+            shared->evicted_bytes += before - _unassembled_byte;
         }
-        // 向前移动迭代器
-        iter--;
-        // 从当前位置开始，向前遍历 _blocks 集合，尝试合并重叠的块
-        while((merged_bytes = merge_block(elm, *iter)) >= 0){
-            // 减少未组装的字节数
-            _unassembled_byte -= merged_bytes;
-            // 从 _blocks 集合中移除已合并的块
-            _blocks.erase(iter);
-            // 重新找到第一个起始位置大于等于 elm.begin 的块
-            iter = _blocks.lower_bound(elm);
-            // 如果已经到了 _blocks 集合的开头，说明前面没有可合并的块了，跳出循环
-            if(iter == _blocks.begin()){
-                break;
+    }
+    _shared_budget.update(_unassembled_byte, _mode == Mode::IntervalMap ? _blocks.size() : 0);
+}
+
+// 从最后一个块开始整块删除，最后只截掉部分字节的块用 resize 缩短，不会重新分配内存
+void StreamReassembler::evict_blocks(size_t bytes) {
+    while (bytes > 0 && !_blocks.empty()) {
+        const auto last = prev(_blocks.end());
+        const size_t n = min(bytes, last->second.size());
+        if (n == last->second.size()) {
+            _blocks.erase(last);
+        } else {
+            last->second.resize(last->second.size() - n);
+        }
+        _unassembled_byte -= n;
+        bytes -= n;
+    }
+}
+
+// 从窗口最远端（_head_index + _capacity - 1）往回逐字扫描位图，清除置位的位
+void StreamReassembler::evict_ring(size_t bytes) {
+    size_t hi = _head_index + _capacity;  // 尚未扫描的流下标范围是 [_head_index, hi)
+    while (bytes > 0 && hi > _head_index) {
+        const size_t pos = (hi - 1) % _capacity;
+        // 本次检查 pos 所在字中从字首到 pos 的位，不能越过 _head_index
+        const size_t n = min(pos % 64 + 1, hi - _head_index);
+        const size_t low = pos % 64 + 1 - n;
+        const uint64_t mask = (n == 64 ? ~uint64_t{0} : (uint64_t{1} << n) - 1) << low;
+        uint64_t &word = _bitmap[pos / 64];
+        uint64_t hit = word & mask;
+        if (size_t(__builtin_popcountll(hit)) <= bytes) {
+            word &= ~hit;
+            bytes -= __builtin_popcountll(hit);
+            _unassembled_byte -= __builtin_popcountll(hit);
+        } else {
+            // 只清除最高的 bytes 个位
+            for (; bytes > 0; --bytes, --_unassembled_byte) {
+                const uint64_t top = uint64_t{1} << (63 - __builtin_clzll(hit));
+                hit &= ~top;
+                word &= ~top;
             }
-            // 向前移动迭代器
-            iter--;
         }
-    // 由于条件为 false，循环只会执行一次
-    }while(false);
-
-    // 将处理后的块插入到 _blocks 集合中
-    _blocks.insert(elm);
-
-    // 检查是否有可以写入输出流的连续块
-    if(!_blocks.empty() && _blocks.begin()->begin == _head_index){
-        // 获取第一个块
-        const block_node head_block = *_blocks.begin();
-        // 将该块的数据写入输出流，返回实际写入的字节数
-        size_t write_bytes = _output.write(head_block.data);
-        // 更新 _head_index 为下一个等待组装的字节的索引
-        _head_index += write_bytes;
-        // 减少未组装的字节数
-        _unassembled_byte -= write_bytes;
-        // 从 _blocks 集合中移除已写入输出流的块
-        _blocks.erase(_blocks.begin());
+        hi -= n;
     }
+}
+
+// 可接收范围不超过 _capacity 字节，所以 [begin, end) 在环上最多绕回一次，拆成两段处理
+void StreamReassembler::insert_into_ring(const string_view data, const size_t index, const size_t begin, const size_t end) {
+    const size_t len = end - begin;
+    const size_t pos = begin % _capacity;
+    const size_t first = min(len, _capacity - pos);
+    memcpy(_buffer.data() + pos, data.data() + (begin - index), first);
+    memcpy(_buffer.data(), data.data() + (begin - index) + first, len - first);
+    // 重复到达的字节已经置位，不会被重复计入未重组字节数
+    _unassembled_byte += set_bits(pos, first) + set_bits(0, len - first);
+}
+
+// 从 _head_index 对应的位开始，按字找第一个 0 位（对取反后的字做 ctz），得到连续到达的字节数
+void StreamReassembler::flush_ring() {
+    if (_unassembled_byte == 0) {
+        return;
+    }
+    const size_t start = _head_index % _capacity;
+    size_t pos = start;
+    size_t run = 0;
+    while (run < _unassembled_byte) {
+        const size_t bit = pos % 64;
+        // 本次最多检查到字的末尾，不能越过环尾，也不能绕回到已统计过的位置
+        const size_t avail = min({64 - bit, _capacity - pos, _unassembled_byte - run});
+        const uint64_t missing = ~_bitmap[pos / 64] >> bit;
+        const size_t n = min(missing == 0 ? 64 - bit : size_t(__builtin_ctzll(missing)), avail);
+        run += n;
+        pos += n;
+        if (n < avail) {
+            break;
+        }
+        if (pos == _capacity) {
+            pos = 0;
+        }
+    }
+    if (run == 0) {
+        return;
+    }
+    // 连续的字节在环上最多分成两段写入输出流
+    const size_t first = min(run, _capacity - start);
+    _output.write(string_view(_buffer.data() + start, first));
+    _output.write(string_view(_buffer.data(), run - first));
+    clear_bits(start, first);
+    clear_bits(0, run - first);
+    _head_index += run;
+    _unassembled_byte -= run;
+}
+
+//! \details 此函数接收来自逻辑流的一个子字符串（也称为一个段），该子字符串可能是乱序的。
+//! 它会将任何新的连续子字符串进行组装，并按顺序写入输出流中。
+void StreamReassembler::push_substring(const string_view data, const size_t index, const bool eof) {
+    // 可接收的范围是 [_head_index, 第一个未被读取的字节 + _capacity)
+    // 第一个未被读取的字节 = _head_index - 输出流中尚未被读走的字节数
+    const size_t first_unacceptable = _head_index + (_capacity - _output.buffer_size());
+    const size_t begin = max(index, _head_index);
+    const size_t end = min(index + data.size(), first_unacceptable);
 
-JUDGE_EOF:
-    // 如果该子字符串是流的最后一部分，设置 eof 标志
-    if (eof) {
+    // 只有整个子串都能放下时才记录 eof
+    if (eof && index + data.size() <= first_unacceptable) {
         _eof_flag = true;
+        _eof_index = index + data.size();
     }
-    // 如果已经收到 eof 标志且没有未组装的数据块，结束输入
-    if (_eof_flag && empty()) {
+
+    if (begin <= _head_index && _unassembled_byte == 0) {
+        // 快速路径：子串从 _head_index 开始且没有乱序数据，直接写入输出流，不碰 map / 环形缓冲区
+        ++_fast_path_segments;
+        if (begin < end) {
+            _head_index += _output.write(data.substr(begin - index, end - begin));
+        }
+    } else if (_mode == Mode::Ring) {
+        ++_slow_path_segments;
+        if (begin < end) {
+            insert_into_ring(data, index, begin, end);
+        }
+        flush_ring();
+        enforce_limits();
+    } else {
+        ++_slow_path_segments;
+        if (begin < end) {
+            insert_new_bytes(data, index, begin, end);
+        }
+        flush_blocks();
+        enforce_limits();
+    }
+
+    // 所有字节都已经写入输出流，结束输入
+    if (_eof_flag && _head_index == _eof_index) {
         _output.end_input();
     }
 }
@@ -173,6 +270,52 @@ JUDGE_EOF:
 // 返回已存储但尚未重组的子字符串中的字节数。
 size_t StreamReassembler::unassembled_bytes() const { return _unassembled_byte; }
 
+// IntervalMap 模式合并首尾相接的块；Ring 模式从 _head_index 开始按字扫描位图，
+// 在每个字内交替用 ctz 跳过一段 0 位和一段 1 位，找齐所有未重组字节就停止
+vector<pair<size_t, size_t>> StreamReassembler::unassembled_ranges() const {
+    vector<pair<size_t, size_t>> ranges;
+    if (_mode == Mode::IntervalMap) {
+        for (const auto &[index, data] : _blocks) {
+            if (!ranges.empty() && ranges.back().second == index) {
+                ranges.back().second += data.size();
+            } else {
+                ranges.emplace_back(index, index + data.size());
+            }
+        }
+        return ranges;
+    }
+    const size_t end = _head_index + _capacity;
+    size_t index = _head_index;
+    size_t found = 0;
+    bool in_range = false;
+    while (index < end && found < _unassembled_byte) {
+        const size_t pos = index % _capacity;
+        const size_t bit = pos % 64;
+        const size_t n = min(64 - bit, _capacity - pos);
+        const uint64_t mask = n == 64 ? ~uint64_t{0} : (uint64_t{1} << n) - 1;
+        const uint64_t word = (_bitmap[pos / 64] >> bit) & mask;
+        size_t k = 0;
+        while (k < n) {
+            // 找下一个状态翻转的位：在区间内找 0 位，在区间外找 1 位
+            const uint64_t rest = (in_range ? ~word : word) >> k;
+            const size_t run = min(n - k, rest == 0 ? size_t{64} : size_t(__builtin_ctzll(rest)));
+            if (in_range) {
+                ranges.back().second += run;
+                found += run;
+            }
+            k += run;
+            if (k < n) {
+                in_range = !in_range;
+                if (in_range) {
+                    ranges.emplace_back(index + k, index + k);
+                }
+            }
+        }
+        index += n;
+    }
+    return ranges;
+}
+
 // 检查内部状态是否为空（除了输出流之外）。
 // 如果没有子字符串等待组装，则返回 `true`，否则返回 `false`。
 bool StreamReassembler::empty() const { return _unassembled_byte == 0; }
\ No newline at end of file
@@ -4,51 +4,159 @@
 #include "byte_stream.hh"
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <iostream>
+#include <limits>
 #include <list>
-#include <set>
+#include <map>
+#include <memory>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <vector>
 
 //! \brief 一个将字节流的一系列片段（可能是乱序的，也可能是重叠的）组装成有序字节流的类。
 class StreamReassembler {
+  public:
+    //! 乱序数据的存储方式
+    enum class Mode {
+        IntervalMap,  //!< 有序 map 存放互不重叠的数据块，内存随乱序数据量增长
+        Ring          //!< 预分配 capacity 字节的环形缓冲区加位图，内存固定为 capacity + capacity/8
+    };
+
+    //! 多个重组器（例如同一进程中的所有连接）共享的未重组数据总预算
+    //! \note 共享的连接可以各在一个线程中运行，所以计数都是原子的；几个线程同时插入时合计可能短暂超出上限，
+    //! 各自下一次插入时就会淘汰回来
+    struct SharedBudget {
+        size_t max_bytes = std::numeric_limits<size_t>::max();      //!< 合计最多缓存的未重组字节数
+        size_t max_fragments = std::numeric_limits<size_t>::max();  //!< 合计最多缓存的块数（只计 IntervalMap 模式）
+        std::atomic<size_t> used_bytes{0};                           //!< 当前合计缓存的未重组字节数
+        std::atomic<size_t> used_fragments{0};                       //!< 当前合计缓存的块数
+        std::atomic<uint64_t> evicted_bytes{0};  //!< 共享此预算的重组器合计淘汰的字节数
+    };
+
   private:
-    struct block_node {
-      size_t begin = 0;
-      size_t length = 0;
-      std::string data = "";
-      // 使用 std::set 存储 block_node 对象，由于 block_node 重载了小于运算符，
-      // 所以 _blocks 中的元素会按照起始位置 begin 自动排序
-      bool operator<(const block_node t) const { return begin < t.begin;}
+    //! 本重组器在共享预算中占用的字节数和块数；析构时归还，拷贝时重新计入
+    class BudgetShare {
+        std::shared_ptr<SharedBudget> _budget{};
+        size_t _held = 0;
+        size_t _held_fragments = 0;
+
+        //! 把计数中本重组器的部分从 `from` 改为 `to`，只做一次原子加减，不会覆盖其他线程的更新
+        static void adjust(std::atomic<size_t> &counter, const size_t from, const size_t to) {
+            if (to > from) {
+                counter.fetch_add(to - from);
+            } else {
+                counter.fetch_sub(from - to);
+            }
+        }
+
+      public:
+        BudgetShare() = default;
+        BudgetShare(const BudgetShare &other) : _budget(other._budget) { update(other._held, other._held_fragments); }
+        BudgetShare(BudgetShare &&other) noexcept
+            : _budget(std::move(other._budget)), _held(other._held), _held_fragments(other._held_fragments) {}
+        BudgetShare &operator=(BudgetShare other) noexcept {
+            std::swap(_budget, other._budget);
+            std::swap(_held, other._held);
+            std::swap(_held_fragments, other._held_fragments);
+            return *this;
+        }
+        ~BudgetShare() { update(0, 0); }
+
+        void reset(std::shared_ptr<SharedBudget> budget) {
+            update(0, 0);
+            _budget = std::move(budget);
+        }
+        //! 把占用的字节数更新为 `held`，块数更新为 `fragments`
+        void update(const size_t held, const size_t fragments) {
+            if (_budget) {
+                adjust(_budget->used_bytes, _held, held);
+                adjust(_budget->used_fragments, _held_fragments, fragments);
+            }
+            _held = held;
+            _held_fragments = fragments;
+        }
+        SharedBudget *get() const { return _budget.get(); }
+        size_t held() const { return _held; }
+        size_t held_fragments() const { return _held_fragments; }
     };
-    std::set<block_node> _blocks = {};
+
+    Mode _mode;
+    // 尚未重组的数据块：key 为块在流中的起始下标，value 为块的数据
+    // 各块之间互不重叠（std::map 按起始下标有序），新到的子串只保存与已有块不重叠的那部分字节，
+    // 已有块的数据不会被拼接或重新复制
+    std::map<size_t, std::string> _blocks = {};
+    // Ring 模式：下标为 i 的字节存放在 _buffer[i % _capacity]，并在 _bitmap 的第 i % _capacity 位做标记
     std::vector<char> _buffer = {};
+    std::vector<uint64_t> _bitmap = {};
     size_t _unassembled_byte = 0;
     size_t _head_index = 0;
     bool _eof_flag = false;
+    size_t _eof_index = 0;  // 流结束位置（最后一个字节之后的下标），_eof_flag 为真时有效
     ByteStream _output; // 重组后的有序字节流
     size_t _capacity;   // 最大字节数
+    uint64_t _fast_path_segments = 0;  // 直接写入输出流的按序子串个数
+    uint64_t _slow_path_segments = 0;  // 需要经过乱序缓存的子串个数
+    // 乱序数据的上限：超出时从离 _head_index 最远的数据开始淘汰（类似 Linux 的 ofo 队列裁剪）
+    size_t _max_unassembled_bytes = std::numeric_limits<size_t>::max();
+    size_t _max_fragments = std::numeric_limits<size_t>::max();  // 只约束 IntervalMap 模式的块数
+    BudgetShare _shared_budget{};
+    uint64_t _evicted_bytes = 0;
+    uint64_t _evictions = 0;  // 发生淘汰的次数
+
+    //! 把 `data`（起始下标为 `index`）中落在 [begin, end) 内、且没有被已有块覆盖的字节作为新块插入
+    void insert_new_bytes(const std::string_view data, const size_t index, size_t begin, const size_t end);
+
+    //! 把从 _head_index 开始连续的块写入输出流（IntervalMap 模式）
+    void flush_blocks();
+
+    //! 把 `data` 中落在 [begin, end) 内的字节写入环形缓冲区并标记（Ring 模式）
+    void insert_into_ring(const std::string_view data, const size_t index, const size_t begin, const size_t end);
+
+    //! 用位图找出从 _head_index 开始连续到达的字节，写入输出流并清除标记（Ring 模式）
+    void flush_ring();
 
-    //! merge elm2 to elm1, return merged bytes
-    long merge_block(block_node &elm1, const block_node &elm2);
+    //! 超出上限时淘汰最远的乱序数据，并更新共享预算
+    void enforce_limits();
 
+    //! 从最远的块开始淘汰 `bytes` 个未重组字节（IntervalMap 模式）
+    void evict_blocks(size_t bytes);
+
+    //! 从窗口最远端开始淘汰 `bytes` 个未重组字节（Ring 模式）
+    void evict_ring(size_t bytes);
+
+    //! 把环形位置 [pos, pos + len) 的位全部置 1（不跨越环尾），返回其中新置位的个数
+    size_t set_bits(const size_t pos, const size_t len);
+
+    //! 把环形位置 [pos, pos + len) 的位全部清零（不跨越环尾）
+    void clear_bits(const size_t pos, const size_t len);
 
   public:
     //! \brief 构造一个最多可存储 `capacity` 字节的 `StreamReassembler` 对象。
     //! \note 这个容量既限制了已经重组的字节数，也限制了尚未重组的字节数。
-    StreamReassembler(const size_t capacity);
+    StreamReassembler(const size_t capacity, const Mode mode = Mode::IntervalMap);
+
+    //! \brief 设置乱序数据的上限
+    //! \param max_bytes 本重组器最多缓存的未重组字节数
+    //! \param max_fragments 本重组器最多缓存的块数（只对 IntervalMap 模式有效）
+    //! \param shared 与其他重组器共享的字节和块数总预算，可以为空
+    void set_limits(const size_t max_bytes,
+                    const size_t max_fragments = std::numeric_limits<size_t>::max(),
+                    std::shared_ptr<SharedBudget> shared = nullptr);
 
     //! \brief 接收一个子字符串，并将任何新的连续字节写入流中。
     //! 
     //! 如果接受所有数据会超出此 `StreamReassembler` 的 `capacity`，那么只会接受适合的那部分数据。
     //! 如果子字符串只是部分被接受，那么 `eof` 标志将被忽略。
     //! 
+    //! 复杂度为 O(k log n)：n 为已缓存的块数，k 为新子串覆盖到的已有块数。
+    //! 
     //! \param data 要添加的字符串
     //! \param index `data` 中第一个字节的索引
     //! \param eof 此段数据是否以流的结尾结束
-    void push_substring(const std::string &data, const uint64_t index, const bool eof);
+    void push_substring(const std::string_view data, const uint64_t index, const bool eof);
 
     //! \name 访问重组后的字节流
     //!@{
@@ -63,10 +171,30 @@ class StreamReassembler {
     //! \note 如果某个特定索引处的字节已被提交两次，在此函数的计算中该字节应只计算一次。
     size_t unassembled_bytes() const;
 
+    //! \brief 已存储但尚未重组的字节组成的各个连续区间 [begin, end)（流下标），按下标升序排列
+    //! \note 用于生成 SACK 块；相邻的块会合并成一个区间
+    std::vector<std::pair<size_t, size_t>> unassembled_ranges() const;
+
     //! \brief 内部状态是否为空（除了输出流之外）？
     //! \returns 如果没有子字符串等待组装，则返回 `true`
     bool empty() const;
 
+    //! \name 快慢路径统计
+    //!@{
+    //! 从 _head_index 开始、且没有乱序数据缓存时直接写入输出流的子串个数
+    uint64_t fast_path_segments() const { return _fast_path_segments; }
+    //! 经过乱序缓存（IntervalMap 或 Ring）的子串个数
+    uint64_t slow_path_segments() const { return _slow_path_segments; }
+    //!@}
+
+    //! \name 淘汰统计
+    //!@{
+    //! 因超出上限而淘汰的未重组字节数
+    uint64_t evicted_bytes() const { return _evicted_bytes; }
+    //! 发生淘汰的次数
+    uint64_t evictions() const { return _evictions; }
+    //!@}
+
     size_t head_index() const { return _head_index; }
     bool input_ended() const { return _output.input_ended(); }
 };
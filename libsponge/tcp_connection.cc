@@ -38,16 +38,52 @@ void TCPConnection::segment_received(const TCPSegment &seg) {
     }
     bool send_empty = false;
 
+    // 对端的 SYN 带了 SACK-permitted 选项，而本端也愿意使用 SACK
+    if(seg.header().syn && seg.header().options.sack_permitted && _cfg.sack){
+        _sack_enabled = true;
+    }
+    // 对端的 SYN 带了时间戳选项，而本端也愿意使用
+    if(seg.header().syn && seg.header().options.timestamps.has_value() && _cfg.timestamps){
+        _ts_enabled = true;
+    }
+    // 时间戳过旧的段（PAWS）整个丢弃，连同其中的确认，只回复一个 ACK
+    if(_ts_enabled && _receiver.paws_rejects(seg)){
+        if(_receiver.ackno().has_value() && _sender.segments_out().empty()){
+            _sender.send_empty_segment();
+        }
+        push_segments_out();
+        return;
+    }
+    // 对端 SYN 中的 MSS 选项限制本端发出的段大小；没有该选项时沿用本端的 MSS
+    if(seg.header().syn && seg.header().options.mss.has_value()){
+        _sender.set_peer_mss(*seg.header().options.mss);
+    }
+    // 对端的 SYN 带了窗口缩放选项；本端的 SYN 总会带上它，所以此时窗口缩放已经协商成功
+    if(seg.header().syn && seg.header().options.window_scale.has_value()){
+        _snd_wscale = min(*seg.header().options.window_scale, TCPHeader::MAX_WINDOW_SCALE);
+    }
+
     // 如果发送方已经发送了数据且接受到的段带有ACK
     if(_sender.next_seqno_absolute() > 0 && seg.header().ack){
+        // 没有协商 SACK 时忽略对端的 SACK 块
+        static const TCPHeader::SACKBlocks no_sack_blocks{};
+        const auto &sack_blocks = _sack_enabled ? seg.header().options.sack_blocks : no_sack_blocks;
+        // SYN 段中的窗口从不缩放
+        const size_t window = seg.header().syn ? seg.header().win : size_t(seg.header().win) << _snd_wscale.value_or(0);
+        // 协商了时间戳时，把对端回显的 TSval 交给发送方采样 RTT
+        const auto &timestamps = seg.header().options.timestamps;
+        const auto ts_echo = _ts_enabled && timestamps.has_value() ? make_optional(timestamps->echo_reply) : nullopt;
         // 如果接收到的ACK不是一个新的有效确认，可能是一个重复的 ACK 标记需要发送一个空段
-        if(!_sender.ack_received(seg.header().ackno, seg.header().win)){
+        const bool pure_ack = seg.length_in_sequence_space() == 0;
+        if(!_sender.ack_received(seg.header().ackno, window, pure_ack, sack_blocks, ts_echo)){
             // 指示需要发送一个空段来再次确认相关信息  应对重复确认的情况
             send_empty = true;
         }
     }
 
-    // 调用接收方处理接受到的段 并记录处理结果
+    // 调用接收方处理接受到的段 并记录处理结果，延迟确认要知道它是否推进了确认号、之前是否有空洞
+    const auto ackno_before = _receiver.ackno();
+    const bool had_holes = _receiver.unassembled_bytes() > 0;
     bool recv_flag = _receiver.segment_received(seg);
     if(!recv_flag){
         send_empty = true;
@@ -70,9 +106,9 @@ void TCPConnection::segment_received(const TCPSegment &seg) {
         return;
     }
 
-    // 如果接收到的段在序列号空间中有长度
-    if(seg.length_in_sequence_space() > 0){
-        send_empty = true;
+    // 如果接收到的段在序列号空间中有长度，需要确认；按序到达的数据可以延迟确认
+    if(seg.length_in_sequence_space() > 0 && !send_empty){
+        send_empty = !delay_ack(seg, _receiver.ackno() != ackno_before, had_holes);
     }
 
     // 如果需要发送空段
@@ -98,6 +134,13 @@ size_t TCPConnection::write(const string &data) {
     return ret;
 }
 
+// 从 fd 直接读入发送方的字节流，并尝试发送
+size_t TCPConnection::write_from_fd(FileDescriptor &fd, const size_t limit) {
+    size_t ret = _sender.stream_in().read_from_fd(fd, limit);
+    push_segments_out();
+    return ret;
+}
+
 //! \param[in] ms_since_last_tick 自上次调用该函数以来运行了多久
 // 当时间流逝时调用此方法，处理超时等情况
 void TCPConnection::tick(const size_t ms_since_last_tick) { 
@@ -113,11 +156,36 @@ void TCPConnection::tick(const size_t ms_since_last_tick) {
         // 异常关闭连接，发送 RST 段
         unclean_shutdown(true);
     }
+    // 推进定时器轮：逗留时间到了就结束连接，cork 到了上限就发出积攒的数据；重传和 pacing 已经由发送方在 tick 中处理
+    _timers.advance(ms_since_last_tick, [&](const TimerWheel::TimerId id) {
+        if (id == LINGER_TIMER) {
+            _active = false;
+        } else if (id == CORK_TIMER) {
+            _sender.flush();
+        } else if (id == DELAYED_ACK_TIMER && _receiver.ackno().has_value() && _sender.segments_out().empty()) {
+            _sender.send_empty_segment();
+        }
+    });
     // 保证每次定时器被调用的时候，都能推送数据，因为_sender的tick()函数会将超时的重新加入_sender的输出队列
     // 因此需要调用此函数来保证重传的数据也能正确发送
     push_segments_out();
 }
 
+// 只有上次通告的窗口偏小（不到容量的一半）、读走数据后窗口至少翻倍时才主动发送窗口更新（同 Linux），
+// 且至少大出 min(容量/2, MSS)（RFC 1122 接收方 SWS 避免）；其余情况由下一个 ACK 顺带通告新的窗口，
+// 否则每读走一个段就会多发一个 ACK
+void TCPConnection::inbound_stream_consumed() {
+    if(!_active || !_receiver.ackno().has_value()){
+        return;
+    }
+    const size_t window = _receiver.window_size();
+    const size_t threshold = min(_cfg.recv_capacity / 2, _cfg.mss);
+    if(2 * _window_advertised <= _cfg.recv_capacity && window >= 2 * _window_advertised &&
+       window >= _window_advertised + threshold){
+        send_ack();
+    }
+}
+
 // 关闭发送方的字节流
 void TCPConnection::end_input_stream() {
     // 标记发送方字节流输入结束
@@ -125,6 +193,14 @@ void TCPConnection::end_input_stream() {
     push_segments_out();
 }
 
+// 设置 cork，取消时立即发出积攒的数据
+void TCPConnection::set_corked(const bool corked) {
+    _sender.set_corked(corked);
+    if (!corked) {
+        push_segments_out();
+    }
+}
+
 // 发起一个 TCP 连接
 void TCPConnection::connect() {
     // 连接时，必须主动发送一个 SYN 段
@@ -147,6 +223,14 @@ TCPConnection::~TCPConnection() {
 
 // 将发送方的段推送到待发送队列
 bool TCPConnection::push_segments_out(bool send_syn){
+    // 有乱序数据时，本次发出的段都带上同样的 SACK 块，新数据段为它们和时间戳留出空间
+    const auto sack_blocks = _sack_enabled ? _receiver.sack_blocks() : TCPHeader::SACKBlocks{};
+    TCPOptions data_options{};
+    data_options.sack_blocks = sack_blocks;
+    if(_ts_enabled){
+        data_options.timestamps = TCPOptions::Timestamps{};
+    }
+    _sender.set_option_space(data_options.size());
     // 处于syn_recv状态时，需要发送SYN_ACK段
     _sender.fill_window(send_syn || in_syn_recv());
 
@@ -163,8 +247,41 @@ bool TCPConnection::push_segments_out(bool send_syn){
             seg.header().ack = true;
             // 设置段的确认号
             seg.header().ackno = _receiver.ackno().value();
-            // 设置段的窗口大小
-            seg.header().win = _receiver.window_size();
+            // 设置段的窗口大小：协商了窗口缩放时按本端的位移缩小（SYN 段除外），超出 16 位的部分截断为最大值
+            const uint8_t shift = seg.header().syn ? 0 : (_snd_wscale.has_value() ? _rcv_wscale : 0);
+            seg.header().win = min<size_t>(_receiver.window_size() >> shift, UINT16_MAX);
+            _window_advertised = _receiver.window_size();
+            _receiver.ack_sent();
+            // 任何带确认的段都捎带了延迟中的确认
+            _segments_unacked = 0;
+            _timers.disarm(DELAYED_ACK_TIMER);
+            seg.header().options.sack_blocks = sack_blocks;
+        }
+        // 主动打开时提出时间戳，之后只在协商成功时携带：TSval 取本端时钟，TSecr 回显对端最近的 TSval
+        if(_ts_enabled || (seg.header().syn && !seg.header().ack && _cfg.timestamps)){
+            const uint32_t ts_echo = _receiver.ts_recent().value_or(0);
+            seg.header().options.timestamps = TCPOptions::Timestamps{_sender.ts_value(), ts_echo};
+        }
+        if(seg.header().ack){
+            // 之前按较少的选项切分的重传段放不下全部 SACK 块时，去掉最旧的几个，段不超过 MSS
+            auto &options = seg.header().options;
+            const size_t payload = seg.payload().size();
+            while (!options.sack_blocks.empty() && payload <= _sender.mss() &&
+                   payload + options.size() > _sender.mss()) {
+                options.sack_blocks.pop_back();
+            }
+        }
+        // SYN 和 SYN-ACK 都告知本端能接收的段大小
+        if(seg.header().syn){
+            seg.header().options.mss = min<size_t>(_cfg.mss, UINT16_MAX);
+        }
+        // 主动打开时总是提出窗口缩放，SYN-ACK 只在对端提出过时才回应
+        if(seg.header().syn && (!seg.header().ack || _snd_wscale.has_value())){
+            seg.header().options.window_scale = _rcv_wscale;
+        }
+        // 主动打开时总是提出 SACK，SYN-ACK 只在对端提出过时才同意
+        if(seg.header().syn && _cfg.sack && (!seg.header().ack || _sack_enabled)){
+            seg.header().options.sack_permitted = true;
         }
         // 如果需要发送 RST 段
         if(_need_send_rst){
@@ -176,9 +293,57 @@ bool TCPConnection::push_segments_out(bool send_syn){
     }
     // 尝试正常关闭连接
     clean_shutdown();
+    update_timers();
+    return true;
+}
+
+// 把发送方的重传定时器和 pacing 等待同步到定时器轮上，连接结束后不再需要任何定时器
+void TCPConnection::update_timers(){
+    const auto arm = [&](const Timer timer, const optional<size_t> delay) {
+        if (_active && delay.has_value()) {
+            _timers.arm(timer, _timers.now() + *delay);
+        } else {
+            _timers.disarm(timer);
+        }
+    };
+    arm(RETX_TIMER, _sender.time_until_retransmission());
+    arm(PACING_TIMER, _sender.time_until_next_send());
+    // cork 上限从数据开始被扣住时算起，之后的写入不推迟它
+    if (!_active || !_sender.corked() || !_sender.holding_data()) {
+        _timers.disarm(CORK_TIMER);
+    } else if (!_timers.armed(CORK_TIMER)) {
+        _timers.arm(CORK_TIMER, _timers.now() + CORK_CEILING_MS);
+    }
+    if (!_active) {
+        _timers.disarm(LINGER_TIMER);
+        _timers.disarm(DELAYED_ACK_TIMER);
+    }
+}
+
+// 乱序数据（没有推进确认号）、填补空洞的数据、SYN 和 FIN 立即确认；其余的数据段每两个确认一次，
+// 第一个到达时启动延迟确认定时器。返回 true 表示这次的确认可以延迟
+bool TCPConnection::delay_ack(const TCPSegment &seg, const bool advanced, const bool had_holes){
+    if(!_cfg.delayed_ack || seg.header().syn || seg.header().fin || !advanced || had_holes ||
+       _receiver.unassembled_bytes() > 0){
+        return false;
+    }
+    if(++_segments_unacked >= 2){
+        return false;
+    }
+    if(!_timers.armed(DELAYED_ACK_TIMER)){
+        _timers.arm(DELAYED_ACK_TIMER, _timers.now() + _cfg.delayed_ack_timeout);
+    }
     return true;
 }
 
+// 立即发送一个确认：没有其他段可以捎带时发送一个空段
+void TCPConnection::send_ack(){
+    if(_receiver.ackno().has_value() && _sender.segments_out().empty()){
+        _sender.send_empty_segment();
+    }
+    push_segments_out();
+}
+
 // @brief 由于RST引起的连接中断
 // @param send_rst 是否需要发送RST段
 void TCPConnection::unclean_shutdown(bool send_rst){
@@ -196,6 +361,7 @@ void TCPConnection::unclean_shutdown(bool send_rst){
         }
         push_segments_out();
     }
+    update_timers();
 }
 
 // 尝试正常关闭 TCP 连接
@@ -212,6 +378,9 @@ bool TCPConnection::clean_shutdown(){
         if(!_linger_after_streams_finish || time_since_last_segment_received() >= 10*_cfg.rt_timeout){
             // 标记连接不活跃
             _active = false;
+        } else {
+            // 逗留到最后一次收到段之后的 10 倍重传超时时间，每收到一个段都会推迟
+            _timers.arm(LINGER_TIMER, _timers.now() + 10*_cfg.rt_timeout - time_since_last_segment_received());
         }
     }
     return !_active;
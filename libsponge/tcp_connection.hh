@@ -5,15 +5,16 @@
 #include "tcp_receiver.hh"
 #include "tcp_sender.hh"
 #include "tcp_state.hh"
+#include "timer_wheel.hh"
 
 //! \brief 一个完整的 TCP 连接端点
 class TCPConnection {
   private:
     TCPConfig _cfg;  // TCP 连接的配置信息
-    // 接收端，使用配置中的接收缓冲区容量进行初始化
-    TCPReceiver _receiver{_cfg.recv_capacity};
+    // 接收端，使用配置中的接收缓冲区容量和重组器模式进行初始化
+    TCPReceiver _receiver{_cfg.recv_capacity, _cfg.reassembler_mode};
     // 发送端，使用配置中的发送缓冲区容量、重传超时时间和固定初始序列号进行初始化
-    TCPSender _sender{_cfg.send_capacity, _cfg.rt_timeout, _cfg.fixed_isn};
+    TCPSender _sender{_cfg};
 
     //! 待发送的 TCP 段队列，TCPConnection 想要发送的段会存放在这里
     std::queue<TCPSegment> _segments_out{};
@@ -26,8 +27,38 @@ class TCPConnection {
     bool _active = true;
     bool _need_send_rst = false;
     bool _ack_for_fin_sent = false;
+    // 双方的 SYN 都带了 SACK-permitted 选项：确认携带 SACK 块，发送方按对端的 SACK 块恢复
+    bool _sack_enabled = false;
+    // 双方的 SYN 都带了时间戳选项（RFC 7323）：之后每个段都带时间戳，确认按回显采样 RTT，接收方执行 PAWS
+    bool _ts_enabled = false;
+    // 本端的窗口缩放位移（RFC 7323）：使 recv_capacity 能放进 16 位窗口字段的最小位移，SYN 上总是提出
+    uint8_t _rcv_wscale = 0;
+    // 对端 SYN 中的窗口缩放位移，有值即表示双方都提出了窗口缩放，之后两个方向的窗口都按位移缩放
+    std::optional<uint8_t> _snd_wscale{};
+
+    // 延迟确认：收到但还没有确认的数据段个数，第二个到达时立即确认
+    size_t _segments_unacked = 0;
+    // 最近一次通告的接收窗口，应用读走数据使窗口明显变大时发送窗口更新
+    size_t _window_advertised = 0;
+
+    // 连接的定时器：重传、逗留（TIME_WAIT）、pacing 等待、cork 上限和延迟确认
+    enum Timer : TimerWheel::TimerId {
+        RETX_TIMER,
+        LINGER_TIMER,
+        PACING_TIMER,
+        CORK_TIMER,
+        DELAYED_ACK_TIMER,
+        TIMER_COUNT
+    };
+    // cork 住的数据最多等待的时间（毫秒），同 Linux 的 TCP_CORK
+    static constexpr size_t CORK_CEILING_MS = 200;
+    // 定时器轮，时钟随 tick 前进；所有者据此知道下一次需要调用 tick 的时间，空闲时不必定期唤醒
+    TimerWheel _timers{TIMER_COUNT};
 
     bool push_segments_out(bool send_syn = false);
+    bool delay_ack(const TCPSegment &seg, const bool advanced, const bool had_holes);
+    void send_ack();
+    void update_timers();
     void unclean_shutdown(bool send_rst);
     bool clean_shutdown();
     bool in_listen();
@@ -45,11 +76,21 @@ class TCPConnection {
     //! \returns 实际从 `data` 中写入的字节数
     size_t write(const std::string &data);
 
+    //! \brief 从 `fd` 读取最多 `limit` 字节直接放入出站字节流（不经过临时字符串），并在可能的情况下发送
+    //! \returns 实际读入的字节数
+    size_t write_from_fd(FileDescriptor &fd, const size_t limit);
+
     //! \returns 当前可以立即写入的字节数
     size_t remaining_outbound_capacity() const;
 
     //! \brief 关闭出站字节流（仍然允许读取传入的数据）
     void end_input_stream();
+
+    //! \brief 类似 TCP_CORK：cork 时只发送满 MSS 的段，不满的数据最多积攒 200 毫秒；取消 cork 时立即发出
+    void set_corked(const bool corked);
+
+    //! \brief 应用从入站字节流读出数据之后调用：通告过的窗口偏小而现在打开得足够多时立即通告新的窗口
+    void inbound_stream_consumed();
     //!@}
 
     //! \name 面向读取方的 “输出” 接口
@@ -68,6 +109,15 @@ class TCPConnection {
     size_t unassembled_bytes() const;
     //! \brief 自上次接收到段以来经过的毫秒数
     size_t time_since_last_segment_received() const;
+    //! \brief 发送方的平滑 RTT（毫秒），还没有样本时为空
+    std::optional<double> srtt() const { return _sender.srtt(); }
+    //! \brief 发送方的 RTT 偏差（毫秒）
+    double rttvar() const { return _sender.rttvar(); }
+    //! \brief 发送方当前的重传超时时间（毫秒）
+    size_t retransmission_timeout() const { return _sender.retransmission_timeout(); }
+    //! \brief 发送方当前的段大小，以及握手协商出的上限
+    size_t mss() const { return _sender.mss(); }
+    size_t max_mss() const { return _sender.max_mss(); }
     //!< \brief 总结发送端、接收端和连接的状态
     TCPState state() const { return {_sender, _receiver, active(), _linger_after_streams_finish}; };
     //!@}
@@ -81,6 +131,10 @@ class TCPConnection {
     //! 当时间流逝时定期调用
     void tick(const size_t ms_since_last_tick);
 
+    //! \brief 距离下一个定时器到期还有多少毫秒，所有者最晚应在那时调用 tick
+    //! \returns 没有定时器在运行时为空，连接只需等待网络或应用的事件
+    std::optional<size_t> time_until_next_timer() const { return _timers.time_until_next(); }
+
     //! \brief TCPConnection 已排入队列等待传输的 TCP 段
     //! \note 所有者或操作系统将从队列中取出这些段，并将每个段放入下层数据报（通常是互联网数据报 (IP)，
     //! 但也可以是用户数据报 (UDP) 或任何其他类型）的有效负载中。
@@ -92,7 +146,13 @@ class TCPConnection {
     //!@}
 
     //! 根据配置构造一个新的连接
-    explicit TCPConnection(const TCPConfig &cfg) : _cfg{cfg} {}
+    explicit TCPConnection(const TCPConfig &cfg) : _cfg{cfg} {
+        _receiver.reassembler().set_limits(
+            _cfg.reassembler_max_unassembled, _cfg.reassembler_max_fragments, _cfg.reassembler_shared_budget);
+        while (_rcv_wscale < TCPHeader::MAX_WINDOW_SCALE && (_cfg.recv_capacity >> _rcv_wscale) > UINT16_MAX) {
+            ++_rcv_wscale;
+        }
+    }
 
     //! \name 构造和析构
     //! 允许移动操作；禁止复制操作；不允许默认构造
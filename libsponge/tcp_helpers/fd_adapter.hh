@@ -42,6 +42,8 @@ class FdAdapterBase {
 //! \brief A FD adaptor that reads and writes TCP segments in UDP payloads
 class TCPOverUDPSocketAdapter : public FdAdapterBase, public UDPSocket {
   public:
+    static constexpr size_t IP_OVERHEAD = 28;  //!< Bytes of IPv4 and UDP headers around each TCP segment
+
     //! Construct from a UDPSocket sliced into a FileDescriptor
     explicit TCPOverUDPSocketAdapter(FileDescriptor &&fd) : UDPSocket(std::move(fd)) {}
 
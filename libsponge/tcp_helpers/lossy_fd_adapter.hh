@@ -29,7 +29,19 @@ class LossyFdAdapter {
         return loss != 0 && uint16_t(_rand()) < loss;
     }
 
+    //! \brief Determine whether a segment is too large for the emulated path MTU
+    //! \param[in] seg is the segment about to be written
+    //! \returns `true` if the datagram carrying `seg` would be larger than FdAdapterConfig::path_mtu
+    bool _too_big(const TCPSegment &seg) const {
+        const auto &cfg = _adapter.config();
+        const size_t size =
+            AdapterT::IP_OVERHEAD + TCPHeader::LENGTH + seg.header().options.size() + seg.payload().size();
+        return cfg.path_mtu != 0 && size > cfg.path_mtu;
+    }
+
   public:
+    static constexpr size_t IP_OVERHEAD = AdapterT::IP_OVERHEAD;  //!< AdapterT::IP_OVERHEAD passthrough
+
     //! Conversion to a FileDescriptor by returning the underlying AdapterT
     operator const FileDescriptor &() const { return _adapter; }
 
@@ -49,8 +61,10 @@ class LossyFdAdapter {
 
     //! \brief Write to the underlying AdapterT instance, potentially dropping the datagram to be written
     //! \param[in] seg is the packet to either write or drop
+    //! \note Datagrams larger than the path MTU are always dropped, like a router that drops them
+    //! without an ICMP error (a PMTU black hole)
     void write(TCPSegment &seg) {
-        if (_should_drop(true)) {
+        if (_should_drop(true) or _too_big(seg)) {
             return;
         }
         return _adapter.write(seg);
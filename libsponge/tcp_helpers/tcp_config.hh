@@ -2,10 +2,14 @@
 #define SPONGE_LIBSPONGE_TCP_CONFIG_HH
 
 #include "address.hh"
+#include "congestion_control.hh"
+#include "stream_reassembler.hh"
 #include "wrapping_integers.hh"
 
 #include <cstddef>
 #include <cstdint>
+#include <limits>
+#include <memory>
 #include <optional>
 
 //! Config for TCP sender and receiver
@@ -13,13 +17,62 @@ class TCPConfig {
   public:
     static constexpr size_t DEFAULT_CAPACITY = 64000;  //!< Default capacity
     static constexpr size_t MAX_PAYLOAD_SIZE = 1452;   //!< Max TCP payload that fits in either IPv4 or UDP datagram
+    static constexpr uint16_t MTU_DFLT = 1500;         //!< Default link MTU
     static constexpr uint16_t TIMEOUT_DFLT = 1000;     //!< Default re-transmit timeout is 1 second
     static constexpr unsigned MAX_RETX_ATTEMPTS = 8;   //!< Maximum re-transmit attempts before giving up
+    static constexpr uint16_t DELAYED_ACK_DFLT = 40;   //!< Default delayed-ACK timeout, as in Linux
 
     uint16_t rt_timeout = TIMEOUT_DFLT;       //!< Initial value of the retransmission timeout, in milliseconds
+    //! Derive the RTO from measured RTTs (RFC 6298) instead of keeping rt_timeout for the whole connection
+    bool adaptive_rto = false;
+    size_t rto_min = 200;    //!< Lower bound of the adaptive RTO, in milliseconds
+    size_t rto_max = 60000;  //!< Upper bound of the adaptive RTO, also caps exponential backoff, in milliseconds
     size_t recv_capacity = DEFAULT_CAPACITY;  //!< Receive capacity, in bytes
     size_t send_capacity = DEFAULT_CAPACITY;  //!< Sender capacity, in bytes
     std::optional<WrappingInt32> fixed_isn{};
+    //! Largest payload per segment, options included: advertised to the peer in the SYN's MSS option and
+    //! the bound, together with the peer's MSS, on segments sent. TCPSpongeSocket derives it from the MTU
+    size_t mss = MAX_PAYLOAD_SIZE;
+    //! Packetization-layer path MTU discovery (RFC 4821): start at a conservative segment size, probe for
+    //! larger ones up to the MSS, and fall back when full-sized segments keep timing out (a black hole)
+    bool mtu_probing = false;
+    //! Congestion control used by the sender (None: limited only by the receiver's window)
+    CongestionControlAlgorithm congestion_control = CongestionControlAlgorithm::None;
+    //! Retransmit on the third duplicate ACK and recover with NewReno partial ACKs (RFC 6582) instead of
+    //! waiting for the RTO; always on when congestion control is enabled
+    bool fast_retransmit = false;
+    //! Offer SACK (RFC 2018) on the SYN; when the peer agrees, ACKs carry SACK blocks for out-of-order data
+    //! and loss recovery retransmits only the holes (RFC 6675). Implies fast_retransmit
+    bool sack = false;
+    //! Offer timestamps (RFC 7323) on the SYN; when the peer agrees, every segment carries one, the sender
+    //! samples the RTT from the echo on every ACK (retransmissions included), and the receiver rejects
+    //! segments with an old timestamp (PAWS)
+    bool timestamps = false;
+    //! Spread new segments over time instead of sending the whole window at once. Congestion controls that
+    //! pace themselves (BBR) always do
+    bool pacing = false;
+    //! Pacing rate in bytes per second; 0 derives it from the window and SRTT (2x the window per SRTT in
+    //! slow start, 1.2x afterwards), with no pacing until the first RTT sample
+    size_t pacing_rate = 0;
+    //! Nagle's algorithm (RFC 896): hold a segment shorter than the MSS while any data is unacknowledged
+    bool nagle = false;
+    //! Hold a segment shorter than the MSS only while an earlier short segment is unacknowledged
+    //! (Minshall's refinement of Nagle), so that small writes coalesce but the tail of a bulk write is not delayed
+    bool autocork = false;
+    //! Delayed ACKs (RFC 1122, RFC 5681): acknowledge in-order data on every second segment or after
+    //! delayed_ack_timeout, unless outgoing data carries the ACK first. Out-of-order data, data that fills
+    //! a hole, FIN and window updates are still acknowledged at once
+    bool delayed_ack = false;
+    uint16_t delayed_ack_timeout = DELAYED_ACK_DFLT;  //!< Longest an ACK is held back, in milliseconds
+    //! How the receiver stores out-of-order bytes (Ring bounds memory at capacity + capacity/8)
+    StreamReassembler::Mode reassembler_mode = StreamReassembler::Mode::IntervalMap;
+    //! Most out-of-order bytes the receiver holds before evicting the farthest-ahead ones
+    size_t reassembler_max_unassembled = std::numeric_limits<size_t>::max();
+    //! Most out-of-order fragments the receiver holds (IntervalMap mode only)
+    size_t reassembler_max_fragments = std::numeric_limits<size_t>::max();
+    //! Out-of-order byte and fragment budget shared by every connection built from this config (none if empty);
+    //! the connections may run on different threads
+    std::shared_ptr<StreamReassembler::SharedBudget> reassembler_shared_budget{};
 };
 
 //! Config for classes derived from FdAdapter
@@ -28,8 +81,11 @@ class FdAdapterConfig {
     Address source{"0", 0};       //!< Source address and port
     Address destination{"0", 0};  //!< Destination address and port
 
+    uint16_t mtu = TCPConfig::MTU_DFLT;  //!< MTU of the local link: the largest datagram the adapter writes
+
     uint16_t loss_rate_dn = 0;  //!< Downlink loss rate (for LossyFdAdapter)
     uint16_t loss_rate_up = 0;  //!< Uplink loss rate (for LossyFdAdapter)
+    uint16_t path_mtu = 0;      //!< Drop outgoing datagrams larger than this (for LossyFdAdapter; 0 for no limit)
 };
 
 #endif  // SPONGE_LIBSPONGE_TCP_CONFIG_HH
@@ -1,5 +1,6 @@
 #include "tcp_header.hh"
 
+#include <algorithm>
 #include <sstream>
 
 using namespace std;
@@ -37,8 +38,13 @@ ParseResult TCPHeader::parse(NetParser &p) {
         return ParseResult::HeaderTooShort;
     }
 
-    // skip any options or anything extra in the header
-    p.remove_prefix(doff * 4 - TCPHeader::LENGTH);
+    // fast path: most segments carry no options
+    const size_t options_length = doff * 4 - TCPHeader::LENGTH;
+    if (options_length == 0) {
+        options = {};
+    } else {
+        options.parse(p, options_length);
+    }
 
     if (p.error()) {
         return p.get_error();
@@ -54,14 +60,19 @@ string TCPHeader::serialize() const {
         throw runtime_error("TCP header too short");
     }
 
+    const uint8_t doff_out = max<size_t>(doff, (TCPHeader::LENGTH + options.size()) / 4);
+    if (doff_out > 15) {
+        throw runtime_error("TCP options too long");
+    }
+
     string ret;
-    ret.reserve(4 * doff);
+    ret.reserve(4 * doff_out);
 
     NetUnparser::u16(ret, sport);              // source port
     NetUnparser::u16(ret, dport);              // destination port
     NetUnparser::u32(ret, seqno.raw_value());  // sequence number
     NetUnparser::u32(ret, ackno.raw_value());  // ack number
-    NetUnparser::u8(ret, doff << 4);           // data offset
+    NetUnparser::u8(ret, doff_out << 4);       // data offset
 
     const uint8_t fl_b = (urg ? 0b0010'0000 : 0) | (ack ? 0b0001'0000 : 0) | (psh ? 0b0000'1000 : 0) |
                          (rst ? 0b0000'0100 : 0) | (syn ? 0b0000'0010 : 0) | (fin ? 0b0000'0001 : 0);
@@ -72,7 +83,10 @@ string TCPHeader::serialize() const {
 
     NetUnparser::u16(ret, uptr);  // urgent pointer
 
-    ret.resize(4 * doff);  // expand header to advertised size
+    if (!options.empty()) {
+        options.serialize(ret);
+    }
+    ret.resize(4 * doff_out);  // expand header to advertised size
 
     return ret;
 }
@@ -90,6 +104,7 @@ string TCPHeader::to_string() const {
        << "TCP winsize: " << +win << '\n'
        << "TCP cksum: " << +cksum << '\n'
        << "TCP uptr: " << +uptr << '\n';
+    ss << options.to_string();
     return ss.str();
 }
 
@@ -104,5 +119,5 @@ bool TCPHeader::operator==(const TCPHeader &other) const {
     // TODO(aozdemir) more complete check (right now we omit cksum, src, dst
     return seqno == other.seqno && ackno == other.ackno && doff == other.doff && urg == other.urg && ack == other.ack &&
            psh == other.psh && rst == other.rst && syn == other.syn && fin == other.fin && win == other.win &&
-           uptr == other.uptr;
+           uptr == other.uptr && options == other.options;
 }
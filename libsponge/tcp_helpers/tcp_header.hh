@@ -2,12 +2,17 @@
 #define SPONGE_LIBSPONGE_TCP_HEADER_HH
 
 #include "parser.hh"
+#include "tcp_options.hh"
 #include "wrapping_integers.hh"
 
 //! \brief [TCP](\ref rfc::rfc793) segment header
-//! \note TCP options are not supported
 struct TCPHeader {
     static constexpr size_t LENGTH = 20;  //!< [TCP](\ref rfc::rfc793) header length, not including options
+    static constexpr size_t MAX_SACK_BLOCKS = 3;  //!< SACK blocks sent per segment (room is left for other options)
+    static constexpr uint8_t MAX_WINDOW_SCALE = 14;  //!< Largest window scale shift allowed by RFC 7323
+
+    using SACKBlock = TCPOptions::SACKBlock;
+    using SACKBlocks = TCPOptions::SACKBlocks;
 
     //! \struct TCPHeader
     //! ~~~{.txt}
@@ -50,10 +55,13 @@ struct TCPHeader {
     uint16_t uptr = 0;          //!< urgent pointer
     //!@}
 
+    TCPOptions options{};  //!< TCP options, see TCPOptions for the ones that are understood
+
     //! Parse the TCP fields from the provided NetParser
     ParseResult parse(NetParser &p);
 
     //! Serialize the TCP fields
+    //! \note `doff` is raised if the options do not fit in the advertised header length
     std::string serialize() const;
 
     //! Return a string containing a header in human-readable format
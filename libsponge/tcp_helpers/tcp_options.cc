@@ -0,0 +1,134 @@
+#include "tcp_options.hh"
+
+#include <sstream>
+
+using namespace std;
+
+namespace {
+
+//! Option kinds
+enum Kind : uint8_t { EOL = 0, NOP = 1, MSS = 2, WINDOW_SCALE = 3, SACK_PERMITTED = 4, SACK = 5, TIMESTAMPS = 8 };
+
+}  // namespace
+
+size_t TCPOptions::size() const {
+    size_t len = 0;
+    len += mss.has_value() ? 4 : 0;
+    len += window_scale.has_value() ? 4 : 0;
+    len += sack_permitted && !timestamps.has_value() ? 4 : 0;
+    len += timestamps.has_value() ? 12 : 0;
+    len += sack_blocks.empty() ? 0 : 4 + 8 * sack_blocks.size();
+    return len;
+}
+
+void TCPOptions::parse(NetParser &p, const size_t length) {
+    *this = {};
+    size_t remaining = length;
+    while (remaining > 0 && !p.error()) {
+        const uint8_t kind = p.u8();
+        --remaining;
+        if (kind == EOL) {
+            break;
+        }
+        if (kind == NOP || remaining == 0) {
+            continue;
+        }
+        const uint8_t len = p.u8();
+        --remaining;
+        if (len < 2 || len - 2u > remaining) {
+            break;  // malformed option: ignore the rest of the option space
+        }
+        const size_t value_len = len - 2;
+        if (kind == MSS && value_len == 2) {
+            mss = p.u16();
+        } else if (kind == WINDOW_SCALE && value_len == 1) {
+            window_scale = p.u8();
+        } else if (kind == SACK_PERMITTED && value_len == 0) {
+            sack_permitted = true;
+        } else if (kind == SACK && value_len % 8 == 0 && value_len / 8 <= SACKBlocks::CAPACITY) {
+            for (size_t i = 0; i < value_len / 8; ++i) {
+                const WrappingInt32 left{p.u32()};
+                const WrappingInt32 right{p.u32()};
+                sack_blocks.push_back({left, right});
+            }
+        } else if (kind == TIMESTAMPS && value_len == 8) {
+            const uint32_t value = p.u32();
+            timestamps = Timestamps{value, p.u32()};
+        } else {
+            p.remove_prefix(value_len);
+        }
+        remaining -= value_len;
+    }
+
+    // skip anything left in the option space
+    p.remove_prefix(remaining);
+}
+
+void TCPOptions::serialize(string &out) const {
+    if (mss.has_value()) {
+        NetUnparser::u8(out, MSS);
+        NetUnparser::u8(out, 4);
+        NetUnparser::u16(out, *mss);
+    }
+    // SACK-permitted and timestamps share one 4-byte-aligned run, which keeps a SYN with every option
+    // (MSS, SACK-permitted, timestamps, window scale) at 20 bytes and in the same order as Linux
+    if (sack_permitted && !timestamps.has_value()) {
+        NetUnparser::u8(out, NOP);
+        NetUnparser::u8(out, NOP);
+    }
+    if (sack_permitted) {
+        NetUnparser::u8(out, SACK_PERMITTED);
+        NetUnparser::u8(out, 2);
+    }
+    if (timestamps.has_value()) {
+        if (!sack_permitted) {
+            NetUnparser::u8(out, NOP);
+            NetUnparser::u8(out, NOP);
+        }
+        NetUnparser::u8(out, TIMESTAMPS);
+        NetUnparser::u8(out, 10);
+        NetUnparser::u32(out, timestamps->value);
+        NetUnparser::u32(out, timestamps->echo_reply);
+    }
+    if (window_scale.has_value()) {
+        NetUnparser::u8(out, NOP);
+        NetUnparser::u8(out, WINDOW_SCALE);
+        NetUnparser::u8(out, 3);
+        NetUnparser::u8(out, *window_scale);
+    }
+    if (!sack_blocks.empty()) {
+        NetUnparser::u8(out, NOP);
+        NetUnparser::u8(out, NOP);
+        NetUnparser::u8(out, SACK);
+        NetUnparser::u8(out, 2 + 8 * sack_blocks.size());
+        for (const auto &block : sack_blocks) {
+            NetUnparser::u32(out, block.left.raw_value());
+            NetUnparser::u32(out, block.right.raw_value());
+        }
+    }
+}
+
+string TCPOptions::to_string() const {
+    stringstream ss{};
+    if (mss.has_value()) {
+        ss << "TCP option: MSS " << *mss << '\n';
+    }
+    if (window_scale.has_value()) {
+        ss << "TCP option: window scale " << +*window_scale << '\n';
+    }
+    if (sack_permitted) {
+        ss << "TCP option: SACK permitted\n";
+    }
+    for (const auto &block : sack_blocks) {
+        ss << "TCP option: SACK " << block.left << "-" << block.right << '\n';
+    }
+    if (timestamps.has_value()) {
+        ss << "TCP option: timestamps " << timestamps->value << " echo " << timestamps->echo_reply << '\n';
+    }
+    return ss.str();
+}
+
+bool TCPOptions::operator==(const TCPOptions &other) const {
+    return mss == other.mss && window_scale == other.window_scale && sack_permitted == other.sack_permitted &&
+           sack_blocks == other.sack_blocks && timestamps == other.timestamps;
+}
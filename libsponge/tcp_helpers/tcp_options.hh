@@ -0,0 +1,114 @@
+#ifndef SPONGE_LIBSPONGE_TCP_OPTIONS_HH
+#define SPONGE_LIBSPONGE_TCP_OPTIONS_HH
+
+#include "parser.hh"
+#include "wrapping_integers.hh"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+//! \brief The [TCP](\ref rfc::rfc793) options this implementation understands, decoded into fixed fields
+//! \details Parsing understands end of list (0), no-op (1), MSS (2), window scale (3, RFC 7323),
+//! SACK-permitted (4), SACK (5, RFC 2018) and timestamps (8, RFC 7323); other kinds are skipped by
+//! their length, and a malformed length ends the option list. Nothing is allocated on the heap.
+struct TCPOptions {
+    static constexpr size_t MAX_LENGTH = 40;  //!< Most option bytes a header can carry
+
+    //! A SACK block: the sender of the header holds sequence numbers [left, right)
+    struct SACKBlock {
+        WrappingInt32 left{0};   //!< first sequence number of the block
+        WrappingInt32 right{0};  //!< sequence number just past the block
+
+        bool operator==(const SACKBlock &other) const { return left == other.left && right == other.right; }
+    };
+
+    //! \brief The SACK blocks of one segment, stored inline
+    //! \note Four blocks are all that fit in the option space
+    class SACKBlocks {
+      public:
+        static constexpr size_t CAPACITY = 4;
+
+      private:
+        std::array<SACKBlock, CAPACITY> _blocks{};
+        size_t _size = 0;
+
+      public:
+        SACKBlocks() = default;
+        SACKBlocks(const std::initializer_list<SACKBlock> blocks) {
+            for (const auto &block : blocks) {
+                push_back(block);
+            }
+        }
+
+        size_t size() const { return _size; }
+        bool empty() const { return _size == 0; }
+        bool full() const { return _size == CAPACITY; }
+
+        //! \throws std::length_error if the list is full
+        void push_back(const SACKBlock &block) {
+            if (full()) {
+                throw std::length_error("SACKBlocks: no room for another block");
+            }
+            _blocks[_size++] = block;
+        }
+
+        void pop_back() { --_size; }
+        void clear() { _size = 0; }
+
+        const SACKBlock &operator[](const size_t i) const { return _blocks[i]; }
+        const SACKBlock *begin() const { return _blocks.data(); }
+        const SACKBlock *end() const { return _blocks.data() + _size; }
+
+        bool operator==(const SACKBlocks &other) const {
+            return std::equal(begin(), end(), other.begin(), other.end());
+        }
+        bool operator!=(const SACKBlocks &other) const { return !(*this == other); }
+    };
+
+    //! The timestamps option
+    struct Timestamps {
+        uint32_t value = 0;       //!< TSval: the sender's clock when the segment was sent
+        uint32_t echo_reply = 0;  //!< TSecr: the most recent TSval received from the peer
+
+        bool operator==(const Timestamps &other) const {
+            return value == other.value && echo_reply == other.echo_reply;
+        }
+    };
+
+    //! \name Options
+    //!@{
+    std::optional<uint16_t> mss{};           //!< maximum segment size, only sent on SYN segments
+    std::optional<uint8_t> window_scale{};   //!< window scale shift count, only sent on SYN segments
+    bool sack_permitted = false;             //!< SACK-permitted, only sent on SYN segments
+    SACKBlocks sack_blocks{};                //!< SACK blocks, most recently changed block first
+    std::optional<Timestamps> timestamps{};  //!< timestamps
+    //!@}
+
+    //! `true` if no option is present, in which case nothing is serialized
+    bool empty() const {
+        return !mss.has_value() && !window_scale.has_value() && !sack_permitted && sack_blocks.empty() &&
+               !timestamps.has_value();
+    }
+
+    //! Number of bytes serialize() appends, a multiple of 4
+    size_t size() const;
+
+    //! Replace the options with the ones in the next `length` bytes of `p`, consuming exactly `length` bytes
+    void parse(NetParser &p, const size_t length);
+
+    //! Append the options to `out`, padded with leading no-ops to multiples of 4 bytes as most stacks do
+    void serialize(std::string &out) const;
+
+    //! Return a string with one line per option present
+    std::string to_string() const;
+
+    bool operator==(const TCPOptions &other) const;
+};
+
+#endif  // SPONGE_LIBSPONGE_TCP_OPTIONS_HH
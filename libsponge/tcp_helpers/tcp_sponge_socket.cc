@@ -4,6 +4,8 @@
 #include "tun.hh"
 #include "util.hh"
 
+#include <algorithm>
+#include <climits>
 #include <cstddef>
 #include <exception>
 #include <iostream>
@@ -17,23 +19,45 @@
 
 using namespace std;
 
-static constexpr size_t TCP_TICK_MS = 10;
+//! \brief The TCP configuration with its MSS derived from the adapter's MTU
+//! \details The MSS is what is left of one MTU-sized datagram after the headers below TCP and the
+//! fixed TCP header; option bytes are taken out of each segment's payload by the sender.
+template <typename AdaptT>
+static TCPConfig mss_for_mtu(const TCPConfig &c_tcp, const FdAdapterConfig &c_ad) {
+    if (c_ad.mtu <= AdaptT::IP_OVERHEAD + TCPHeader::LENGTH) {
+        throw runtime_error("MTU too small for TCP");
+    }
+    TCPConfig cfg = c_tcp;
+    cfg.mss = c_ad.mtu - AdaptT::IP_OVERHEAD - TCPHeader::LENGTH;
+    return cfg;
+}
 
 //! \param[in] condition is a function returning true if loop should continue
+//! \details Sleeps until a file descriptor is ready or the TCPConnection's next timer is due; with no timer
+//! running (e.g. an idle connection with nothing in flight) it waits for I/O alone.
 template <typename AdaptT>
 void TCPSpongeSocket<AdaptT>::_tcp_loop(const function<bool()> &condition) {
-    auto base_time = timestamp_ms();
     while (condition()) {
-        auto ret = _eventloop.wait_next_event(TCP_TICK_MS);
+        const auto next_timer = _tcp.value().active() ? _tcp.value().time_until_next_timer() : nullopt;
+        const int timeout_ms = next_timer.has_value() ? static_cast<int>(min<size_t>(*next_timer, INT_MAX)) : -1;
+        auto ret = _eventloop.wait_next_event(timeout_ms);
         if (ret == EventLoop::Result::Exit or _abort) {
             break;
         }
 
-        if (_tcp.value().active()) {
-            const auto next_time = timestamp_ms();
-            _tcp.value().tick(next_time - base_time);
-            base_time = next_time;
-        }
+        _advance_clock();
+    }
+}
+
+//! \details The event loop may sleep for a whole timer interval before it dispatches an event, so every rule
+//! calls this before it touches the TCPConnection; otherwise a segment would be handled (and an RTT sampled)
+//! with the time the loop went to sleep.
+template <typename AdaptT>
+void TCPSpongeSocket<AdaptT>::_advance_clock() {
+    if (_tcp.value().active()) {
+        const auto now = timestamp_ms();
+        _tcp.value().tick(now - _last_tick);
+        _last_tick = now;
     }
 }
 
@@ -51,6 +75,7 @@ TCPSpongeSocket<AdaptT>::TCPSpongeSocket(pair<FileDescriptor, FileDescriptor> da
 template <typename AdaptT>
 void TCPSpongeSocket<AdaptT>::_initialize_TCP(const TCPConfig &config) {
     _tcp.emplace(config);
+    _last_tick = timestamp_ms();
 
     // Set up the event loop
 
@@ -74,6 +99,7 @@ void TCPSpongeSocket<AdaptT>::_initialize_TCP(const TCPConfig &config) {
     _eventloop.add_rule(_datagram_adapter,
                         Direction::In,
                         [&] {
+                            _advance_clock();
                             auto seg = _datagram_adapter.read();
                             if (seg) {
                                 _tcp->segment_received(move(seg.value()));
@@ -94,12 +120,9 @@ void TCPSpongeSocket<AdaptT>::_initialize_TCP(const TCPConfig &config) {
         _thread_data,
         Direction::In,
         [&] {
-            const auto data = _thread_data.read(_tcp->remaining_outbound_capacity());
-            const auto len = data.size();
-            const auto amount_written = _tcp->write(move(data));
-            if (amount_written != len) {
-                throw runtime_error("TCPConnection::write() accepted less than advertised length");
-            }
+            _advance_clock();
+            // read straight from the pipe into the outbound stream's storage (no temporary string)
+            _tcp->write_from_fd(_thread_data, _tcp->remaining_outbound_capacity());
 
             if (_thread_data.eof()) {
                 _tcp->end_input_stream();
@@ -108,7 +131,11 @@ void TCPSpongeSocket<AdaptT>::_initialize_TCP(const TCPConfig &config) {
                 // debugging output:
                 cerr << "DEBUG: Outbound stream to " << _datagram_adapter.config().destination.to_string()
                      << " finished (" << _tcp.value().bytes_in_flight() << " byte"
-                     << (_tcp.value().bytes_in_flight() == 1 ? "" : "s") << " still in flight).\n";
+                     << (_tcp.value().bytes_in_flight() == 1 ? "" : "s") << " still in flight";
+                if (const auto srtt = _tcp.value().srtt(); srtt.has_value()) {
+                    cerr << ", srtt " << *srtt << " ms, rttvar " << _tcp.value().rttvar() << " ms";
+                }
+                cerr << ", rto " << _tcp.value().retransmission_timeout() << " ms).\n";
             }
         },
         [&] { return (_tcp->active()) and (not _outbound_shutdown) and (_tcp->remaining_outbound_capacity() > 0); },
@@ -122,14 +149,14 @@ void TCPSpongeSocket<AdaptT>::_initialize_TCP(const TCPConfig &config) {
         _thread_data,
         Direction::Out,
         [&] {
+            _advance_clock();
             ByteStream &inbound = _tcp->inbound_stream();
             // Write from the inbound_stream into
             // the pipe, handling the possibility of a partial
-            // write (i.e., only pop what was actually written).
-            const size_t amount_to_write = min(size_t(65536), inbound.buffer_size());
-            const std::string buffer = inbound.peek_output(amount_to_write);
-            const auto bytes_written = _thread_data.write(move(buffer), false);
-            inbound.pop_output(bytes_written);
+            // write (write_to_fd only pops what was actually written).
+            inbound.write_to_fd(_thread_data, 65536);
+            // let the peer know if that opened the window enough to be worth a window update
+            _tcp->inbound_stream_consumed();
 
             if (inbound.eof() or inbound.error()) {
                 _thread_data.shutdown(SHUT_WR);
@@ -152,6 +179,7 @@ void TCPSpongeSocket<AdaptT>::_initialize_TCP(const TCPConfig &config) {
     _eventloop.add_rule(_datagram_adapter,
                         Direction::Out,
                         [&] {
+                            _advance_clock();
                             while (not _tcp->segments_out().empty()) {
                                 _datagram_adapter.write(_tcp->segments_out().front());
                                 _tcp->segments_out().pop();
@@ -179,8 +207,9 @@ TCPSpongeSocket<AdaptT>::~TCPSpongeSocket() {
     try {
         if (_tcp_thread.joinable()) {
             cerr << "Warning: unclean shutdown of TCPSpongeSocket\n";
-            // force the other side to exit
+            // force the other side to exit; shutting down our end of the pipe wakes it if it is waiting
             _abort.store(true);
+            shutdown(SHUT_RDWR);
             _tcp_thread.join();
         }
     } catch (const exception &e) {
@@ -206,7 +235,7 @@ void TCPSpongeSocket<AdaptT>::connect(const TCPConfig &c_tcp, const FdAdapterCon
         throw runtime_error("connect() with TCPConnection already initialized");
     }
 
-    _initialize_TCP(c_tcp);
+    _initialize_TCP(mss_for_mtu<AdaptT>(c_tcp, c_ad));
 
     _datagram_adapter.config_mut() = c_ad;
 
@@ -234,7 +263,7 @@ void TCPSpongeSocket<AdaptT>::listen_and_accept(const TCPConfig &c_tcp, const Fd
         throw runtime_error("listen_and_accept() with TCPConnection already initialized");
     }
 
-    _initialize_TCP(c_tcp);
+    _initialize_TCP(mss_for_mtu<AdaptT>(c_tcp, c_ad));
 
     _datagram_adapter.config_mut() = c_ad;
     _datagram_adapter.set_listening(true);
@@ -37,6 +37,12 @@ class TCPSpongeSocket : public LocalStreamSocket {
     //! Process events while specified condition is true
     void _tcp_loop(const std::function<bool()> &condition);
 
+    //! timestamp_ms() when the TCPConnection's clock was last advanced
+    uint64_t _last_tick{0};
+
+    //! Advance the TCPConnection's clock to the current time
+    void _advance_clock();
+
     //! Main loop of TCPConnection thread
     void _tcp_main();
 
@@ -12,6 +12,8 @@
 //! \brief A FD adapter for IPv4 datagrams read from and written to a TUN device
 class TCPOverIPv4OverTunFdAdapter : public FdAdapterBase, public FileDescriptor {
   public:
+    static constexpr size_t IP_OVERHEAD = 20;  //!< Bytes of IPv4 header around each TCP segment
+
     //! Construct from a TunFD sliced into a FileDescriptor
     explicit TCPOverIPv4OverTunFdAdapter(FileDescriptor &&fd) : FileDescriptor(std::move(fd)) {}
 
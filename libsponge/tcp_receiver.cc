@@ -1,5 +1,6 @@
 #include "tcp_receiver.hh"
 
+#include <algorithm>
 #include <optional>
 
 template <typename... Targs>
@@ -24,9 +25,17 @@ using namespace std;
 // 处理接收到的 TCP 分段
 bool TCPReceiver::segment_received(const TCPSegment &seg) {
     bool ret = false;  // 用于标记分段是否被成功处理
-    static size_t abs_seqno = 0; // 存储绝对序列号，初始化为 0
+    size_t abs_seqno = 0; // 存储绝对序列号
     size_t length;  // 存储当前分段在序列号空间中的长度
 
+    // 时间戳比 TS.Recent 旧的段是序列号回绕前的旧重复段，丢弃（RFC 7323 PAWS）
+    if(paws_rejects(seg)){
+        return false;
+    }
+    // 段的起始序列号不超过上次发出的确认号时，它的时间戳成为新的 TS.Recent（SYN 的总是，RFC 7323 4.3）：
+    // 延迟确认时回显的是被扣住的第一个段的时间戳，RTT 样本包含确认被扣住的时间；乱序到达的段也不会更新它
+    const auto &timestamps = seg.header().options.timestamps;
+
     // 处理 SYN 标志
     if(seg.header().syn){
         // 如果 SYN 标志已经被设置过，说明之前已经收到过 SYN 分段，直接返回 false
@@ -37,6 +46,9 @@ bool TCPReceiver::segment_received(const TCPSegment &seg) {
         _syn_flag = true;  // 设置 SYN 标志，表示已经收到 SYN 分段
         ret = true;        // 标记分段处理成功
         _isn = seg.header().seqno.raw_value();  // 记录初始序列号（ISN）
+        if(timestamps.has_value()){
+            _ts_recent = timestamps->value;
+        }
         abs_seqno = 1;     // 收到 SYN 后，绝对序列号从 1 开始
         _base = 1;         // 接收窗口的起始位置设置为 1
         length = seg.length_in_sequence_space() - 1;  // 减去 SYN 标志占用的一个序列号
@@ -49,10 +61,13 @@ bool TCPReceiver::segment_received(const TCPSegment &seg) {
     else if (!_syn_flag){
         return false;
     } 
-    // 已经收到 SYN 分段，将相对序列号转换为绝对序列号
+    // 已经收到 SYN 分段，以窗口左边界为参照把相对序列号转换为绝对序列号
     else{
-        abs_seqno = unwrap(WrappingInt32(seg.header().seqno.raw_value()), WrappingInt32(_isn), abs_seqno);
+        abs_seqno = unwrap(WrappingInt32(seg.header().seqno.raw_value()), WrappingInt32(_isn), _base);
         length = seg.length_in_sequence_space();  // 获取当前分段在序列号空间中的长度
+        if(timestamps.has_value() && abs_seqno <= _last_ack_sent){
+            _ts_recent = timestamps->value;
+        }
     }
 
     // 处理 FIN 标志
@@ -74,9 +89,14 @@ bool TCPReceiver::segment_received(const TCPSegment &seg) {
             return false;
     }
 
+    // 记下乱序到达的段，生成 SACK 块时把它所在的区间放在最前面
+    if (abs_seqno > _base) {
+        _last_out_of_order = abs_seqno - 1;
+    }
+
     // 将分段的有效载荷数据推送给重组器进行处理
     // 开始重组数据，注意abs_seqno是TCP绝对序列号，会计算SYN，而此时我们需要的索引是针对流的，而流忽略了SYN，因此需要-1.
-    _reassembler.push_substring(seg.payload().copy(), abs_seqno - 1, seg.header().fin);
+    _reassembler.push_substring(seg.payload().str(), abs_seqno - 1, seg.header().fin);
 
     // 更新接收窗口的起始位置 但是窗口的绝对序列不会忽略SYN，而流重组器会忽略SYN，因此为head_index+1，
     _base = _reassembler.head_index() + 1;  
@@ -100,8 +120,39 @@ optional<WrappingInt32> TCPReceiver::ackno() const {
         return std::nullopt;
 }
 
+// TSval 按 32 位回绕比较；RST 不受 PAWS 限制
+bool TCPReceiver::paws_rejects(const TCPSegment &seg) const {
+    const auto &timestamps = seg.header().options.timestamps;
+    return _syn_flag && !seg.header().syn && !seg.header().rst && _ts_recent.has_value() &&
+           timestamps.has_value() && static_cast<int32_t>(timestamps->value - *_ts_recent) < 0;
+}
+
 // 获取接收窗口的大小
 size_t TCPReceiver::window_size() const { 
     // 接收窗口大小等于总容量减去重组器输出流缓冲区中已有的数据量
     return _capacity - _reassembler.stream_out().buffer_size(); 
 }
+
+// 流下标 i 对应绝对序列号 i + 1（SYN 占一个序列号）
+TCPHeader::SACKBlocks TCPReceiver::sack_blocks(const size_t max_blocks) const {
+    TCPHeader::SACKBlocks blocks;
+    if (_base == 0 || _reassembler.empty() || max_blocks == 0) {
+        return blocks;
+    }
+    const auto ranges = _reassembler.unassembled_ranges();
+    const auto to_block = [&](const pair<size_t, size_t> &range) {
+        return TCPHeader::SACKBlock{wrap(range.first + 1, WrappingInt32(_isn)), wrap(range.second + 1, WrappingInt32(_isn))};
+    };
+    const auto latest = find_if(ranges.begin(), ranges.end(), [&](const pair<size_t, size_t> &range) {
+        return range.first <= _last_out_of_order && _last_out_of_order < range.second;
+    });
+    if (latest != ranges.end()) {
+        blocks.push_back(to_block(*latest));
+    }
+    for (auto it = ranges.begin(); it != ranges.end() && blocks.size() < min(max_blocks, TCPHeader::SACKBlocks::CAPACITY); ++it) {
+        if (it != latest) {
+            blocks.push_back(to_block(*it));
+        }
+    }
+    return blocks;
+}
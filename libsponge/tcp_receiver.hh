@@ -7,6 +7,7 @@
 #include "wrapping_integers.hh"
 
 #include <optional>
+#include <vector>
 
 //! \brief The "receiver" part of a TCP implementation.
 
@@ -21,6 +22,12 @@ class TCPReceiver {
     bool _fin_flag = false;
     size_t _base = 0;
     size_t _isn = 0;
+    // 最近一个乱序到达的段的起始流下标，它所在的区间作为第一个 SACK 块（RFC 2018）
+    size_t _last_out_of_order = 0;
+    // 对端最近的时间戳（RFC 7323 的 TS.Recent），用于回显（TSecr）和 PAWS
+    std::optional<uint32_t> _ts_recent{};
+    // 上次发出的确认号（RFC 7323 的 Last.ACK.sent，绝对序列号），决定哪个段的时间戳成为 TS.Recent
+    size_t _last_ack_sent = 0;
     //! The maximum number of bytes we'll store.
     size_t _capacity;
 
@@ -29,7 +36,9 @@ class TCPReceiver {
     //!
     //! \param capacity the maximum number of bytes that the receiver will
     //!                 store in its buffers at any give time.
-    TCPReceiver(const size_t capacity) : _reassembler(capacity), _capacity(capacity) {}
+    //! \param mode how the reassembler stores out-of-order bytes
+    TCPReceiver(const size_t capacity, const StreamReassembler::Mode mode = StreamReassembler::Mode::IntervalMap)
+        : _reassembler(capacity, mode), _capacity(capacity) {}
 
     //! \name Accessors to provide feedback to the remote TCPSender
     //!@{
@@ -52,15 +61,38 @@ class TCPReceiver {
     //! accepted by the receiver) and (b) the sequence number of the
     //! beginning of the window (the ackno).
     size_t window_size() const;
+
+    //! \brief SACK blocks (RFC 2018) describing out-of-order data held above the ackno
+    //!
+    //! The block holding the most recently received out-of-order segment comes first,
+    //! followed by the others in sequence order, at most `max_blocks` in total.
+    TCPHeader::SACKBlocks sack_blocks(const size_t max_blocks = TCPHeader::MAX_SACK_BLOCKS) const;
+
+    //! \brief The timestamp to echo to the peer (TS.Recent, RFC 7323)
+    //! \returns empty if no segment with the timestamps option has been received
+    std::optional<uint32_t> ts_recent() const { return _ts_recent; }
     //!@}
 
+    //! \brief Record that an ACK carrying the current ackno has been sent (Last.ACK.sent, RFC 7323)
+    void ack_sent() { _last_ack_sent = _base; }
+
+    //! \brief PAWS (RFC 7323): a segment whose timestamp is older than TS.Recent is an old duplicate
+    //! \returns `true` if segment_received() will drop the segment for its timestamp
+    bool paws_rejects(const TCPSegment &seg) const;
+
     //! \brief number of bytes stored but not yet reassembled
     size_t unassembled_bytes() const { return _reassembler.unassembled_bytes(); }
 
     //! \brief handle an inbound segment
-    //! \returns `true` if any part of the segment was inside the window
+    //! \returns `true` if any part of the segment was inside the window and it passed PAWS
     bool segment_received(const TCPSegment &seg);
 
+    //! \brief the reassembler holding out-of-order bytes (for its limits and statistics)
+    //!@{
+    StreamReassembler &reassembler() { return _reassembler; }
+    const StreamReassembler &reassembler() const { return _reassembler; }
+    //!@}
+
     //! \name "Output" interface for the reader
     //!@{
     ByteStream &stream_out() { return _reassembler.stream_out(); }
@@ -2,6 +2,8 @@
 
 #include "tcp_config.hh"
 
+#include <algorithm>
+#include <cmath>
 #include <random>
 
 // Dummy implementation of a TCP sender
@@ -24,12 +26,38 @@ using namespace std;
 //! \param[in] retx_timeout 重传最旧的未确认分段之前等待的初始时间
 //! \param[in] fixed_isn 初始序列号（ISN），如果设置了则使用该值，否则使用随机生成的 ISN
 TCPSender::TCPSender(const size_t capacity, const uint16_t retx_timeout, const std::optional<WrappingInt32> fixed_isn)
+    : TCPSender([&] {
+        TCPConfig cfg;
+        cfg.send_capacity = capacity;
+        cfg.rt_timeout = retx_timeout;
+        cfg.fixed_isn = fixed_isn;
+        return cfg;
+    }()) {}
+
+//! \param[in] cfg 发送方的配置
+TCPSender::TCPSender(const TCPConfig &cfg)
     // 如果 fixed_isn 有值则使用该值，否则使用随机生成的 ISN
     // value_or 用于在 std::optional 对象有值时返回其存储的值，在对象为空时返回一个默认值
-    : _isn(fixed_isn.value_or(WrappingInt32{random_device()()})) 
-    , _initial_retransmission_timeout{retx_timeout}
-    , _stream(capacity)
-    , _retransmission_timeout(retx_timeout) {}
+    : _isn(cfg.fixed_isn.value_or(WrappingInt32{random_device()()}))
+    , _stream(cfg.send_capacity, ByteStream::Mode::Chunked)
+    , _retransmission_timeout(cfg.rt_timeout)
+    , _adaptive_rto(cfg.adaptive_rto)
+    , _rto_min(cfg.rto_min)
+    , _rto_max(cfg.rto_max)
+    , _rto(cfg.rt_timeout)
+    , _fast_retransmit(cfg.fast_retransmit || cfg.sack || cfg.congestion_control != CongestionControlAlgorithm::None)
+    , _configured_mss(cfg.mss)
+    , _max_mss(cfg.mss)
+    , _mss(cfg.mtu_probing ? min(PROBE_BASE_MSS, cfg.mss) : cfg.mss)
+    , _mtu_probing(cfg.mtu_probing)
+    , _probe_low(_mss)
+    , _probe_high(_max_mss)
+    , _cc_algorithm(cfg.congestion_control)
+    , _cc(make_congestion_control(cfg.congestion_control, _mss))
+    , _pacing(cfg.pacing)
+    , _configured_pacing_rate(cfg.pacing_rate / 1000.0)
+    , _nagle(cfg.nagle)
+    , _autocork(cfg.autocork) {}
 
 // 获取当前正在传输中的字节数
 uint64_t TCPSender::bytes_in_flight() const { return _bytes_in_flight; }
@@ -50,19 +78,40 @@ void TCPSender::fill_window(bool send_syn) {
         return;
     }
 
+    _holding = false;
+
     // take window_size as 1 when it equal 0
-    size_t win = _window_size > 0 ? _window_size : 1;
+    // 接收方窗口限制已发送未确认的序列号范围，拥塞窗口限制 pipe（没有 SACK 时就是在途字节数）
+    const size_t rwnd = _window_size > 0 ? _window_size : 1;
+    const size_t cwnd = _window_size > 0 ? congestion_window() : SIZE_MAX;
+    const size_t win = min(rwnd, cwnd);
+    // 有 pacing 速率时，新段还要等 tick 攒够发送额度
+    const bool paced = pacing_rate().has_value();
     // window's free space
-    size_t remain;  
+    size_t remain;
     // when window isn't full and never sent FIN
-    while ((remain = win - (_next_seqno - _recv_ackno)) != 0 && !_fin_flag) {
+    // 拥塞窗口缩小后，已发送的字节数可能超过窗口
+    while (_next_seqno - _recv_ackno < rwnd && pipe() < cwnd && !_fin_flag && (!paced || _pacing_budget > 0)) {
+        remain = min(rwnd - (_next_seqno - _recv_ackno), cwnd - pipe());
         // 取最大有效载荷大小和窗口剩余空间的最小值作为本次要发送的数据大小
-        size_t size = min(TCPConfig::MAX_PAYLOAD_SIZE, remain);
+        size_t size = min(payload_size(), remain);
+        // PLPMTUD：数据和窗口都够一个探测段时，这一段按探测大小（包括选项）发送
+        const size_t probe = next_probe_size();
+        const size_t probe_payload = probe > _option_space ? probe - _option_space : 0;
+        const bool probing =
+            probe_payload > 0 && _stream.buffer_size() >= probe_payload && remain >= probe_payload;
+        if (probing) {
+            size = probe_payload;
+        }
+        // 数据不够填满这个段（段没有被窗口截短），又不能带上 FIN 时，按合并策略先攒着
+        if (_stream.buffer_size() > 0 && _stream.buffer_size() < size && !_stream.input_ended() &&
+            hold_small_segment()) {
+            _holding = true;
+            return;
+        }
         TCPSegment seg;
-        // 从字节流中读取数据
-        string str = _stream.read(size);
-         // 将读取的数据放入分段的有效载荷中
-        seg.payload() = Buffer(std::move(str));
+        // 从字节流中取出数据作为有效载荷：落在一个切片内时直接共享切片，不复制
+        seg.payload() = _stream.read_buffer(size);
         // 如果分段长度小于窗口大小且字节流已结束，添加 FIN 标志 FIN 标志也会消耗一个序列
         if (seg.length_in_sequence_space() < win && _stream.eof()) {
             seg.header().fin = true;
@@ -70,10 +119,43 @@ void TCPSender::fill_window(bool send_syn) {
         }
         // 如果分段长度为 0，说明没有数据可发送，退出循环
         if (seg.length_in_sequence_space() == 0) {
+            // 窗口还有空间却没有数据，之后测得的交付速率受应用限制
+            _app_limited_until = max<uint64_t>(_delivered + _bytes_in_flight, 1);
             return;
         }
+        if (paced) {
+            _pacing_budget -= seg.length_in_sequence_space();
+        }
         send_segment(seg);
+        if (seg.payload().size() > 0 && seg.payload().size() < payload_size()) {
+            _small_segment_end = _next_seqno;
+        }
+        if (probing) {
+            _probe_size = probe;
+            _probe_end = _next_seqno;
+        }
+    }
+}
+
+// cork 时总是扣住；Nagle 在还有任何未确认数据时扣住；autocork 只在之前的小段还没被确认时扣住，
+// 所以连续的小写入会合并，而大块数据最后的零头不用等一个 RTT
+bool TCPSender::hold_small_segment() const {
+    if (_flushing) {
+        return false;
+    }
+    if (_corked) {
+        return true;
+    }
+    if (_nagle && _bytes_in_flight > 0) {
+        return true;
     }
+    return _autocork && _recv_ackno < _small_segment_end;
+}
+
+void TCPSender::flush() {
+    _flushing = true;
+    fill_window(false);
+    _flushing = false;
 }
 
 // 函数设计思路：
@@ -87,12 +169,16 @@ void TCPSender::fill_window(bool send_syn) {
 /*
  * @brief 是否收到了新的确认
  * @param[in] ackno 远端接收方的确认号,即期待发送方的下一个序号
- * @param[in] window_size 远程接收器的窗口大小
+ * @param[in] window_size 远程接收器的窗口大小（字节数，已按窗口缩放还原）
  * @details 可以导致TCPSender发送一个段的方法
  * @attention 采用累积确认
  * @return 如果确认无效（确认TCPSender尚未发送的内容），返回‘ false ’
  */
-bool TCPSender::ack_received(const WrappingInt32 ackno, const uint16_t window_size) {
+bool TCPSender::ack_received(const WrappingInt32 ackno,
+                             const size_t window_size,
+                             const bool pure_ack,
+                             const TCPHeader::SACKBlocks &sack_blocks,
+                             const optional<uint32_t> ts_echo) {
     // 将相对确认号转换为绝对确认号
     size_t abs_ackno = unwrap(ackno, _isn, _recv_ackno);
     // 大于下一个要发送的绝对序列号，返回 false
@@ -101,42 +187,146 @@ bool TCPSender::ack_received(const WrappingInt32 ackno, const uint16_t window_si
     }
 
     // 如果确认号合法，更新窗口大小
+    const bool window_changed = window_size != _window_size;
     _window_size = window_size;
 
+    const bool new_sack = update_scoreboard(sack_blocks);
+
     // 如果确认号已经被接收过，直接返回 true
     if (abs_ackno <= _recv_ackno) {
+        // 重复确认（RFC 5681）：没有数据、窗口不变、确认号等于最大确认号且还有未确认的数据
+        // 带 SACK 块时还要报告了新的 SACK 数据（RFC 6675）
+        if (abs_ackno == _recv_ackno && pure_ack && !window_changed && !_segments_outstanding.empty() &&
+            (sack_blocks.empty() || new_sack)) {
+            dup_ack_received();
+        }
+        if (_sacked_bytes > 0) {
+            mark_lost();
+        }
+        if (_lost_bytes > 0) {
+            retransmit_lost();
+        }
+        if (_in_recovery) {
+            fill_window();
+        }
         return true;
     }
 
+    AckEvent event;
+    event.now = _clock;
+    // SYN 不算作数据，不让它撑大拥塞窗口
+    event.acked_bytes = abs_ackno - max<size_t>(_recv_ackno, 1);
     // 更新已接收的确认号
     _recv_ackno = abs_ackno;
+    _dup_acks = 0;
 
-    // 从待确认分段队列中移除所有序列号小于等于确认号的分段
+    // 交付速率样本取本次确认的最新一段：从它发送时到现在交付的字节数，
+    // 除以发送区间和确认区间中较长的那个（draft-cheng-iccrg-delivery-rate-estimation）
+    optional<DeliveryState> newest{};
+    optional<uint64_t> oldest_sent_at{};
+    bool retransmission_acked = false;
+    _delivered += event.acked_bytes;
+    _delivered_at = _clock;
+
+    // 从记分板中移除所有序列号小于等于确认号的分段
     while (!_segments_outstanding.empty()) {
-        TCPSegment seg = _segments_outstanding.front();
+        const OutstandingSegment &front = _segments_outstanding.front();
+        const size_t length = front.length;
         // 判断TCP段是否被确认-----累积确认
         // 小笔记：
         // 已知ack n是确认n-1都已经到达，为什么这里可以等于
         // 因为：例如ack=100,seqno=0,length=100,很明显tcp段的序号是0-99，但是0+100=100,因此可以=
-        if (unwrap(seg.header().seqno, _isn, _next_seqno) + seg.length_in_sequence_space() <= abs_ackno) {
-            _bytes_in_flight -= seg.length_in_sequence_space();
-            _segments_outstanding.pop();
+        if (front.abs_seqno + length <= abs_ackno) {
+            _bytes_in_flight -= length;
+            _sacked_bytes -= front.sacked ? length : 0;
+            _lost_bytes -= front.lost ? length : 0;
+            newest = front.delivery;
+            oldest_sent_at = oldest_sent_at.value_or(newest->sent_at);
+            retransmission_acked |= newest->retransmitted;
+            _segments_outstanding.pop_front();
         } else {
             break;
         }
     }
 
+    // 探测段被确认：路径能通过这么大的段，用它作为新的段大小，继续向上搜索
+    if (_probe_size > 0 && abs_ackno >= _probe_end) {
+        _probe_low = _probe_size;
+        _probe_size = 0;
+        update_mss(_probe_low);
+    }
+
+    // 有时间戳时按回显的 TSval 采样（RFC 7323），确认了重传的段也能采样；回显的时间比本端时钟还新时
+    // 是伪造或被改写的回显，丢弃它（同 Linux 的检查）。
+    // 否则 RTO 按最旧的一段采样（偏保守），拥塞控制按最新的一段采样（更接近路径的真实 RTT）
+    const bool ts_sample = ts_echo.has_value() && static_cast<int32_t>(ts_value() - *ts_echo) >= 0;
+    if (newest.has_value() && ts_sample) {
+        const uint32_t rtt = ts_value() - *ts_echo;
+        update_rtt(rtt);
+        event.rtt = rtt;
+    } else if (newest.has_value() && !retransmission_acked) {
+        update_rtt(_clock - *oldest_sent_at);
+        event.rtt = _clock - newest->sent_at;
+    }
+    if (newest.has_value()) {
+        event.delivered = _delivered;
+        event.prior_delivered = newest->delivered;
+        event.app_limited = newest->app_limited;
+        _first_sent_at = newest->sent_at;
+        const uint64_t interval = max(newest->sent_at - newest->first_sent_at, _clock - newest->delivered_at);
+        if (!newest->retransmitted && interval > 0) {
+            event.delivery_rate = double(_delivered - newest->delivered) / interval;
+        }
+    }
+    if (_app_limited_until != 0 && _delivered > _app_limited_until) {
+        _app_limited_until = 0;
+    }
+
+    // 快速恢复期间：越过恢复点则结束恢复，否则是部分确认，立即重传下一个未确认的段（RFC 6582）
+    // 有 SACK 时只把它判定为丢失（已被 SACK 或已重传过的除外），和其他空洞一起按 pipe 重传
+    if (_in_recovery) {
+        if (abs_ackno >= _recovery_point) {
+            _in_recovery = false;
+            event.exits_recovery = true;
+        } else {
+            event.partial_ack = true;
+            event.sack_recovery = _sack_seen;
+            if (!_segments_outstanding.empty()) {
+                OutstandingSegment &front = _segments_outstanding.front();
+                if (!_sack_seen) {
+                    retransmit_front();
+                } else if (!front.sacked && !front.lost && !front.delivery.retransmitted) {
+                    front.lost = true;
+                    _lost_bytes += front.length;
+                }
+            }
+        }
+    }
+    if (_cc) {
+        event.bytes_in_flight = pipe();
+        _cc->on_ack(event);
+    }
+    // 在拥塞控制处理完确认之后再判定丢失，新进入的快速恢复不会被这次确认撑大窗口
+    if (_sacked_bytes > 0) {
+        mark_lost();
+    }
+    if (_lost_bytes > 0) {
+        retransmit_lost();
+    }
+
     // // 现在接收到了确认之后，就需要窗口往右边移动，因此，对窗口进行填充，并进行发送
     fill_window();
 
     // 重置重传超时时间和连续重传次数
-    _retransmission_timeout = _initial_retransmission_timeout;
+    _retransmission_timeout = _rto;
     _consecutive_retransmission = 0;
 
-    // 如果还有待确认的分段，重启定时器
+    // 如果还有待确认的分段，重启定时器；全部确认后停止定时器，下一个新段重新计时（RFC 6298 5.2）
     if (!_segments_outstanding.empty()) {
         _timer_running = true;
         _timer = 0;
+    } else {
+        _timer_running = false;
     }
     return true;
 }
@@ -147,16 +337,59 @@ bool TCPSender::ack_received(const WrappingInt32 ackno, const uint16_t window_si
 
 // 处理定时器滴答事件，检查是否需要重传
 void TCPSender::tick(const size_t ms_since_last_tick) {
+    _clock += ms_since_last_tick;
+    // 按 pacing 速率补充发送额度，然后放行等待中的段。所有者只在需要时才调用 tick，两次之间可能隔得很久，
+    // 所以空闲期间最多攒下 PACING_MAX_BURST_MS 毫秒的额度（至少两个 MSS），避免空闲之后一次发出整个窗口
+    if (const auto rate = pacing_rate(); rate.has_value()) {
+        constexpr size_t PACING_MAX_BURST_MS = 10;
+        const double quantum =
+            max(*rate * min(ms_since_last_tick, PACING_MAX_BURST_MS), 2.0 * _mss);
+        _pacing_budget = min(_pacing_budget + *rate * ms_since_last_tick, quantum);
+        if (_syn_flag) {
+            fill_window();
+        }
+    }
     // 更新定时器时间
     _timer += ms_since_last_tick;
     // 如果定时器超时且有待确认的分段
     if (_timer >= _retransmission_timeout && !_segments_outstanding.empty()) {
-        // 重传最旧的未确认分段
-        _segments_out.push(_segments_outstanding.front());
+        // 最旧的段被 SACK 过却还要超时重传，说明对端丢弃了 SACK 过的数据（reneging），记分板不再可信
+        if (_segments_outstanding.front().sacked) {
+            for (size_t i = 0; i < _segments_outstanding.size(); ++i) {
+                _segments_outstanding[i].sacked = false;
+            }
+            _sacked_bytes = 0;
+        }
+        // 同一段第二次超时，而且它比保守的段大小还大时，按黑洞处理（分段重传在 retransmit 中进行）
+        const size_t base_mss = min(PROBE_BASE_MSS, _max_mss);
+        if (_mtu_probing && _consecutive_retransmission >= 1 && _mss > base_mss &&
+            _segments_outstanding.front().payload.size() > base_mss) {
+            black_hole_detected();
+        }
+        // 重传最旧的未确认分段；有 SACK 时其余没被 SACK 的段也都判定为丢失，随后的确认按拥塞窗口逐个重传
+        retransmit_front();
+        if (_sack_seen) {
+            for (size_t i = 1; i < _segments_outstanding.size(); ++i) {
+                OutstandingSegment &entry = _segments_outstanding[i];
+                if (!entry.sacked && !entry.lost) {
+                    entry.lost = true;
+                    _lost_bytes += entry.length;
+                }
+            }
+        }
         // 连续重传次数加 1
         _consecutive_retransmission++;
-        // 重传超时时间翻倍
+        // 重传超时时间翻倍，自适应 RTO 时不超过上限
         _retransmission_timeout *= 2;
+        if (_adaptive_rto) {
+            _retransmission_timeout = min(_retransmission_timeout, _rto_max);
+        }
+        // 超时说明快速恢复没能修复丢失，退出快速恢复，由拥塞控制重新慢启动
+        _in_recovery = false;
+        _dup_acks = 0;
+        if (_cc) {
+            _cc->on_rto(_clock, _bytes_in_flight);
+        }
         // 重启定时器
         _timer_running = true;
         _timer = 0;
@@ -167,6 +400,142 @@ void TCPSender::tick(const size_t ms_since_last_tick) {
     }
 }
 
+// 拥塞控制自己做 pacing 时用它的速率；否则开启 pacing 后用配置的速率，没有配置时
+// 按有效窗口除以 SRTT 估计，慢启动期间 2 倍、之后 1.2 倍（同 Linux），窗口增长时速率不会成为瓶颈
+optional<double> TCPSender::pacing_rate() const {
+    if (const auto rate = _cc ? _cc->pacing_rate() : nullopt; rate.has_value()) {
+        return rate;
+    }
+    if (!_pacing) {
+        return nullopt;
+    }
+    if (_configured_pacing_rate > 0) {
+        return _configured_pacing_rate;
+    }
+    if (!_srtt.has_value()) {
+        return nullopt;
+    }
+    const size_t window = min(congestion_window(), max<size_t>(_window_size, 1));
+    const double gain = _cc && _cc->in_slow_start() ? 2.0 : 1.2;
+    return gain * window / max(*_srtt, 1.0);
+}
+
+optional<size_t> TCPSender::time_until_retransmission() const {
+    if (!_timer_running) {
+        return nullopt;
+    }
+    return _retransmission_timeout - min(_timer, _retransmission_timeout);
+}
+
+// 额度按 pacing 速率增长，超过 0 时才能发送，所以要等到 -额度/速率 之后的下一毫秒
+optional<size_t> TCPSender::time_until_next_send() const {
+    const auto rate = pacing_rate();
+    if (!rate.has_value() || *rate <= 0 || _pacing_budget > 0 || !_syn_flag || _fin_flag) {
+        return nullopt;
+    }
+    if (_stream.buffer_empty() && !_stream.eof()) {
+        return nullopt;
+    }
+    return static_cast<size_t>(-_pacing_budget / *rate) + 1;
+}
+
+// 没有开启快速重传时只计数
+void TCPSender::dup_ack_received() {
+    ++_dup_acks;
+    if (!_fast_retransmit) {
+        return;
+    }
+    if (_in_recovery) {
+        // 拥塞控制据此膨胀窗口，让新数据在恢复期间继续发出；有 SACK 时 pipe 已经扣除了离开网络的段
+        if (_cc && !_sack_seen) {
+            _cc->on_dup_ack(_clock, _bytes_in_flight);
+        }
+    } else if (_dup_acks == 3) {
+        // 快速重传最旧的未确认段，记录恢复点后进入快速恢复
+        enter_recovery();
+        retransmit_front();
+    }
+}
+
+void TCPSender::enter_recovery() {
+    if (_cc) {
+        _cc->on_loss(_clock, _bytes_in_flight);
+    }
+    _in_recovery = true;
+    _recovery_point = _next_seqno;
+}
+
+// 记分板按序列号有序，每个块二分找到第一个起点不小于块左端的段，只标记整个落在块内的段
+bool TCPSender::update_scoreboard(const TCPHeader::SACKBlocks &sack_blocks) {
+    bool newly_sacked = false;
+    for (const auto &block : sack_blocks) {
+        _sack_seen = true;
+        const uint64_t left = unwrap(block.left, _isn, _recv_ackno);
+        const uint64_t right = unwrap(block.right, _isn, _recv_ackno);
+        if (left >= right || right > _next_seqno) {
+            continue;
+        }
+        size_t lo = 0, hi = _segments_outstanding.size();
+        while (lo < hi) {
+            const size_t mid = lo + (hi - lo) / 2;
+            if (_segments_outstanding[mid].abs_seqno < left) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        for (size_t i = lo; i < _segments_outstanding.size(); ++i) {
+            OutstandingSegment &entry = _segments_outstanding[i];
+            if (entry.abs_seqno + entry.length > right) {
+                break;
+            }
+            if (!entry.sacked) {
+                entry.sacked = true;
+                _sacked_bytes += entry.length;
+                newly_sacked = true;
+            }
+            if (entry.lost) {
+                entry.lost = false;
+                _lost_bytes -= entry.length;
+            }
+        }
+    }
+    return newly_sacked;
+}
+
+// 从后往前累计其上方被 SACK 的段数和字节数：超过 DupThresh - 1 个 MSS，或者有 DupThresh 个段被 SACK，
+// 下方没被 SACK 的段就判定为丢失。已经重传过的段不再判定，留给超时处理
+void TCPSender::mark_lost() {
+    constexpr size_t DUP_THRESH = 3;
+    size_t sacked_above = 0;
+    size_t sacked_segments_above = 0;
+    for (size_t i = _segments_outstanding.size(); i-- > 0;) {
+        OutstandingSegment &entry = _segments_outstanding[i];
+        if (entry.sacked) {
+            sacked_above += entry.length;
+            ++sacked_segments_above;
+        } else if (!entry.lost && !entry.delivery.retransmitted &&
+                   (sacked_segments_above >= DUP_THRESH ||
+                    sacked_above > (DUP_THRESH - 1) * _mss)) {
+            entry.lost = true;
+            _lost_bytes += entry.length;
+        }
+    }
+    // 最旧的段被判定丢失时，不必等三个重复确认就进入快速恢复
+    if (_fast_retransmit && !_in_recovery && !_segments_outstanding.empty() && _segments_outstanding.front().lost) {
+        enter_recovery();
+    }
+}
+
+void TCPSender::retransmit_lost() {
+    const size_t cwnd = congestion_window();
+    for (size_t i = 0; i < _segments_outstanding.size() && _lost_bytes > 0 && pipe() < cwnd; ++i) {
+        if (_segments_outstanding[i].lost) {
+            retransmit(_segments_outstanding[i]);
+        }
+    }
+}
+
 // 获取连续重传的次数
 unsigned int TCPSender::consecutive_retransmissions() const { return _consecutive_retransmission; }
 
@@ -194,10 +563,26 @@ void TCPSender::send_segment(TCPSegment &seg) {
     seg.header().seqno = wrap(_next_seqno, _isn);
     // 更新下一个要发送的序列号
     _next_seqno += seg.length_in_sequence_space();
+    const uint64_t abs_seqno = _next_seqno - seg.length_in_sequence_space();
     // 增加正在传输中的字节数
     _bytes_in_flight += seg.length_in_sequence_space();
-    // 将分段放入待确认队列
-    _segments_outstanding.push(seg);
+    // 从空闲开始发送时，采样区间从现在算起
+    if (_bytes_in_flight == seg.length_in_sequence_space()) {
+        _first_sent_at = _delivered_at = _clock;
+    }
+    if (_cc) {
+        _cc->on_send(_clock, seg.length_in_sequence_space(), _bytes_in_flight);
+    }
+    // 把重建分段所需的信息放入记分板，负载只增加一个引用计数
+    const DeliveryState delivery{_clock, _delivered, _delivered_at, _first_sent_at, _app_limited_until != 0, false};
+    _segments_outstanding.push_back({abs_seqno,
+                                     seg.length_in_sequence_space(),
+                                     seg.payload(),
+                                     seg.header().syn,
+                                     seg.header().fin,
+                                     delivery,
+                                     false,
+                                     false});
     // 将分段放入发送队列
     _segments_out.push(seg);
 
@@ -206,4 +591,117 @@ void TCPSender::send_segment(TCPSegment &seg) {
         _timer_running = true;
         _timer = 0;
     }
-}
\ No newline at end of file
+}
+
+void TCPSender::retransmit_front() { retransmit(_segments_outstanding.front()); }
+
+// 确认号落在段中间时（对端只收下了段的前一部分），跳过已确认的 SYN 和负载前缀
+void TCPSender::retransmit(OutstandingSegment &entry) {
+    // 重传探测段说明它丢了：路径通不过这么大的段，降低搜索上限
+    if (_probe_size > 0 && entry.abs_seqno + entry.length == _probe_end) {
+        _probe_high = _probe_size - 1;
+        _probe_size = 0;
+    }
+    uint64_t seqno = entry.abs_seqno;
+    bool syn = entry.syn && seqno >= _recv_ackno;
+    seqno += entry.syn && !syn ? 1 : 0;
+    Buffer payload = entry.payload;
+    if (_recv_ackno > seqno) {
+        const size_t acked = min<uint64_t>(_recv_ackno - seqno, payload.size());
+        payload.remove_prefix(acked);
+        seqno += acked;
+    }
+    // 比当前段大小还大的（探测段，或者段大小缩小之前发出的段）拆成几段重传，各段共享原来的负载
+    do {
+        TCPSegment seg;
+        seg.header().syn = syn;
+        seg.header().seqno = wrap(seqno, _isn);
+        if (payload.size() > payload_size()) {
+            seg.payload() = payload.prefix(payload_size());
+            payload.remove_prefix(payload_size());
+        } else {
+            seg.payload() = payload;
+            payload = Buffer{};
+            seg.header().fin = entry.fin;
+        }
+        seqno += seg.length_in_sequence_space();
+        syn = false;
+        _segments_out.push(std::move(seg));
+    } while (payload.size() > 0);
+
+    entry.delivery.retransmitted = true;
+    if (entry.lost) {
+        entry.lost = false;
+        _lost_bytes -= entry.length;
+    }
+}
+
+// 握手期间只发出了 SYN，拥塞控制可以按新的 MSS 重新开始，初始窗口仍是 10 个段
+void TCPSender::set_peer_mss(const size_t mss) {
+    // 连接建立之后重复的 SYN 不再改变段大小
+    if (_next_seqno > 1) {
+        return;
+    }
+    _max_mss = min(_configured_mss, mss);
+    const size_t old_mss = _mss;
+    _mss = _mtu_probing ? min(PROBE_BASE_MSS, _max_mss) : _max_mss;
+    _probe_low = _mss;
+    _probe_high = _max_mss;
+    if (_cc && _mss != old_mss) {
+        _cc = make_congestion_control(_cc_algorithm, _mss);
+    }
+}
+
+// 没有探测在途、不在快速恢复中且搜索还没结束时才探测；搜索结束 PROBE_INTERVAL_MS 之后把上限恢复为最大值重新搜索
+size_t TCPSender::next_probe_size() {
+    if (!_mtu_probing || _probe_size > 0 || _in_recovery) {
+        return 0;
+    }
+    if (search_done()) {
+        if (!_search_done_at.has_value()) {
+            _search_done_at = _clock;
+        }
+        if (_clock - *_search_done_at < PROBE_INTERVAL_MS) {
+            return 0;
+        }
+        _probe_high = _max_mss;
+        _search_done_at = _clock;
+        if (search_done()) {
+            return 0;
+        }
+    }
+    _search_done_at.reset();
+    return (_probe_low + _probe_high + 1) / 2;
+}
+
+void TCPSender::update_mss(const size_t mss) {
+    _mss = mss;
+    if (_cc) {
+        _cc->set_mss(mss);
+    }
+}
+
+// 当前大小的段通不过，作为新的上限；保守大小作为新的下限，从那里重新向上搜索
+void TCPSender::black_hole_detected() {
+    _probe_high = _mss - 1;
+    _probe_low = min(PROBE_BASE_MSS, _max_mss);
+    _probe_size = 0;
+    _search_done_at.reset();
+    update_mss(_probe_low);
+}
+
+// 第一个样本直接作为 SRTT，偏差取它的一半；之后 RTTVAR 以 1/4、SRTT 以 1/8 的权重跟踪新样本。
+// RTO = SRTT + max(G, 4·RTTVAR)，时钟粒度 G 为 1 毫秒
+void TCPSender::update_rtt(const uint64_t rtt) {
+    if (!_srtt.has_value()) {
+        _srtt = rtt;
+        _rttvar = rtt / 2.0;
+    } else {
+        _rttvar = 0.75 * _rttvar + 0.25 * abs(*_srtt - rtt);
+        _srtt = 0.875 * *_srtt + 0.125 * rtt;
+    }
+    if (_adaptive_rto) {
+        const auto rto = static_cast<size_t>(ceil(*_srtt + max(1.0, 4 * _rttvar)));
+        _rto = clamp(rto, _rto_min, _rto_max);
+    }
+}
@@ -4,6 +4,10 @@
 
 // 包含字节流处理的头文件，用于处理待发送的字节流
 #include "byte_stream.hh"
+// 包含拥塞控制接口，cwnd 与接收方窗口共同决定发送窗口
+#include "congestion_control.hh"
+// 包含环形队列，用于存放记分板
+#include "ring_queue.hh"
 // 包含 TCP 配置相关的头文件，提供 TCP 的默认配置参数
 #include "tcp_config.hh"
 // 包含 TCP 段相关的头文件，用于处理 TCP 段的封装和解析
@@ -13,8 +17,11 @@
 
 // 包含标准库中的 functional 头文件，用于处理函数对象
 #include <functional>
+// 包含标准库中的 memory 头文件，用于持有拥塞控制模块
+#include <memory>
 // 包含标准库中的 queue 头文件，用于使用队列数据结构
 #include <queue>
+#include <vector>
 
 // 定义 TCPSender 类，实现 TCP 发送方的功能
 class TCPSender {
@@ -26,17 +33,39 @@ class TCPSender {
     // 待发送的 TCP 段的队列，存储需要发送到网络中的 TCP 段
     std::queue<TCPSegment> _segments_out{};
 
-    // 连接的初始重传超时时间，用于设置重传定时器的初始值
-    unsigned int _initial_retransmission_timeout;
-
-    // 待发送的字节流，存储还未被分割成 TCP 段发送出去的数据
+    // 待发送的字节流，存储还未被分割成 TCP 段发送出去的数据；分块存储，段的负载直接共享其中的切片
     ByteStream _stream;
 
     // 下一个待发送字节的绝对序列号，用于跟踪发送进度
     uint64_t _next_seqno{0};
 
-    // 已发送但未确认的 TCP 段的队列，用于跟踪哪些段还在传输中
-    std::queue<TCPSegment> _segments_outstanding{};
+    // 每个未确认段发送时的交付状态，用于计算交付速率样本
+    struct DeliveryState {
+        uint64_t sent_at;        // 发送时间
+        uint64_t delivered;      // 发送时的累计交付字节数
+        uint64_t delivered_at;   // 发送时最近一次交付的时间
+        uint64_t first_sent_at;  // 发送时所在采样区间第一个段的发送时间
+        bool app_limited;        // 发送时是否处于应用受限
+        bool retransmitted;      // 是否重传过，重传过的段不产生 RTT 和速率样本
+    };
+    // 记分板中的一个未确认段（RFC 6675）：只保存重建这个段所需的信息，负载与发出的段共享同一个 Buffer
+    struct OutstandingSegment {
+        uint64_t abs_seqno = 0;      // 段的绝对序列号
+        size_t length = 0;           // 段在序列号空间中的长度
+        Buffer payload{};            // 段的负载
+        bool syn = false;            // 段是否带 SYN
+        bool fin = false;            // 段是否带 FIN
+        DeliveryState delivery{};    // 发送时的交付状态
+        bool sacked = false;         // 对端已经用 SACK 确认了整个段
+        bool lost = false;           // 判定为丢失且还没有重传
+    };
+    // 已发送但未确认的段组成的记分板，按序列号排列，存放在连续的环形数组中，用于跟踪哪些段还在传输中
+    RingQueue<OutstandingSegment> _segments_outstanding{};
+    // 记分板中被 SACK 的字节数和判定丢失、等待重传的字节数
+    size_t _sacked_bytes = 0;
+    size_t _lost_bytes = 0;
+    // 对端是否发送过 SACK 块，之后的快速恢复按记分板进行
+    bool _sack_seen = false;
     // 已发送但未确认的字节数，记录当前处于传输中的字节数量
     size_t _bytes_in_flight = 0;
     // 接收到的确认号，记录接收方已经成功接收的数据的序列号
@@ -57,9 +86,124 @@ class TCPSender {
     // 连续重传的次数，用于实现 TCP 的重传策略
     size_t _consecutive_retransmission = 0;
 
+    // RTT 估计（RFC 6298，毫秒）：每个确认用它确认的段的发送时间采样，确认到重传过的段则不采样（Karn 算法）
+    std::optional<double> _srtt{};
+    double _rttvar = 0;
+    // 是否按 SRTT + 4·RTTVAR 计算 RTO，否则一直使用初始 RTO；以及 RTO 的下限和上限（上限也限制指数退避）
+    bool _adaptive_rto;
+    size_t _rto_min;
+    size_t _rto_max;
+    // 未退避的 RTO，收到新确认时重传超时时间恢复为它
+    size_t _rto;
+    // 三个重复确认时快速重传并进入快速恢复（开启拥塞控制时总是开启）
+    bool _fast_retransmit;
+
+    // 本端配置的 MSS，以及它和对端 SYN 中 MSS 选项的较小值，即段大小的上限
+    size_t _configured_mss;
+    size_t _max_mss;
+    // 当前的段大小；开启 PLPMTUD 时从保守的大小开始，随探测结果变化
+    size_t _mss;
+    // PLPMTUD（RFC 4821）：不超过 _probe_low 的段已知能通过路径，超过 _probe_high 的已知不能
+    bool _mtu_probing;
+    size_t _probe_low;
+    size_t _probe_high;
+    // 在途探测段的大小（0 表示没有）和结束序列号
+    size_t _probe_size = 0;
+    uint64_t _probe_end = 0;
+    // 上一次搜索结束的时间，PROBE_INTERVAL_MS 之后从上限重新搜索，路径变化后还能用上更大的段
+    std::optional<uint64_t> _search_done_at{};
+    // 保守的起始段大小（同 Linux 的 tcp_base_mss），区间小于 PROBE_THRESHOLD 时搜索结束，以及重新搜索的间隔
+    static constexpr size_t PROBE_BASE_MSS = 1024;
+    static constexpr size_t PROBE_THRESHOLD = 8;
+    static constexpr uint64_t PROBE_INTERVAL_MS = 600000;
+    // 每个段预留给选项的字节数：MSS 不包括选项（RFC 6691），有选项时有效载荷相应减少
+    size_t _option_space = 0;
+
+    // 新数据段的有效载荷大小
+    size_t payload_size() const { return _mss > _option_space ? _mss - _option_space : 1; }
+
+    // 拥塞控制算法，握手确定 MSS 后按新的 MSS 重新创建拥塞控制模块
+    CongestionControlAlgorithm _cc_algorithm;
+
+    // 拥塞控制模块，为空时不限制拥塞窗口
+    std::unique_ptr<CongestionControl> _cc;
+    // 发送方时钟，累加每次 tick 经过的毫秒数
+    uint64_t _clock = 0;
+    // 连续收到的重复确认个数
+    size_t _dup_acks = 0;
+    // 是否处于快速恢复，以及进入快速恢复时的 _next_seqno（恢复点）
+    bool _in_recovery = false;
+    uint64_t _recovery_point = 0;
+
+    // 累计交付的字节数和最近一次交付的时间
+    uint64_t _delivered = 0;
+    uint64_t _delivered_at = 0;
+    // 最近一个被确认的段的发送时间，作为下一个采样区间的起点
+    uint64_t _first_sent_at = 0;
+    // 发送方因为没有数据可发而空闲时记下当时的交付量加在途量，交付越过它之前的样本都受应用限制
+    uint64_t _app_limited_until = 0;
+    // pacing 的发送额度（字节），tick 按 pacing 速率累加，发送新段时扣除
+    double _pacing_budget = 0;
+    // 是否开启 pacing，以及配置的 pacing 速率（字节/毫秒，0 表示按窗口和 SRTT 估计）
+    bool _pacing;
+    double _configured_pacing_rate;
+
+    // 小段的合并策略：Nagle、autocork，以及由所有者设置的 cork
+    bool _nagle;
+    bool _autocork;
+    bool _corked = false;
+    // 最近一个不满 MSS 的数据段的结束序列号，autocork 在它被确认之前扣住新的小段
+    uint64_t _small_segment_end = 0;
+    // 上一次 fill_window 是否因为上面的策略扣住了数据
+    bool _holding = false;
+    // 为真时 fill_window 忽略上面的策略，发出扣住的数据
+    bool _flushing = false;
+
     // 私有成员函数，用于发送一个 TCP 段
     void send_segment(TCPSegment &seg);
 
+    // 重传最旧的未确认段，之后确认到它时不再产生 RTT 和交付速率样本
+    void retransmit_front();
+
+    // 重传记分板中的一段：只发送还没有被累积确认的部分，负载是原 Buffer 的切片，不复制数据
+    void retransmit(OutstandingSegment &entry);
+
+    // 用一个 RTT 样本更新 SRTT 和 RTTVAR，并重新计算 RTO
+    void update_rtt(const uint64_t rtt);
+
+    // 处理一个重复确认：第三个重复确认触发快速重传，快速恢复期间通知拥塞控制膨胀窗口并继续发送
+    void dup_ack_received();
+
+    // 是否按 Nagle、cork 或 autocork 扣住一个不满 MSS 的段
+    bool hold_small_segment() const;
+
+    // 记录丢包并进入快速恢复
+    void enter_recovery();
+
+    // 用 SACK 块标记记分板，返回是否有段第一次被 SACK
+    bool update_scoreboard(const TCPHeader::SACKBlocks &sack_blocks);
+
+    // 把其上方已被 SACK 的数据足够多的段判定为丢失（RFC 6675 IsLost）
+    void mark_lost();
+
+    // 在拥塞窗口允许的范围内按序重传判定丢失的段（RFC 6675 NextSeg 规则 1）
+    void retransmit_lost();
+
+    // RFC 6675 的 pipe：在途字节数减去已被 SACK 的和判定丢失的字节数
+    size_t pipe() const { return _bytes_in_flight - _sacked_bytes - _lost_bytes; }
+
+    // 搜索区间小于 PROBE_THRESHOLD 时搜索结束
+    bool search_done() const { return _probe_high < _probe_low + PROBE_THRESHOLD; }
+
+    // 下一个探测段的大小（搜索区间的中点），不该探测时为 0
+    size_t next_probe_size();
+
+    // 改变段大小并通知拥塞控制
+    void update_mss(const size_t mss);
+
+    // 连续超时的段比保守大小还大，可能是黑洞：退回保守大小，并以当前大小为上限重新搜索
+    void black_hole_detected();
+
   public:
 
     // 构造函数，用于初始化 TCPSender 对象
@@ -70,12 +214,25 @@ class TCPSender {
               const uint16_t retx_timeout = TCPConfig::TIMEOUT_DFLT,
               const std::optional<WrappingInt32> fixed_isn = {});
 
+    // 按配置构造，包括容量、重传超时、初始序列号和拥塞控制算法
+    explicit TCPSender(const TCPConfig &cfg);
+
     // 非 const 版本的输入字节流访问函数，返回字节流的引用
     ByteStream &stream_in() { return _stream; }
     // const 版本的输入字节流访问函数，返回字节流的常量引用
     const ByteStream &stream_in() const { return _stream; }
     // 处理接收到的确认号和窗口大小，返回是否成功处理的布尔值
-    bool ack_received(const WrappingInt32 ackno, const uint16_t window_size);
+    // pure_ack 表示携带确认的段没有数据，只有这样的段才可能被当作重复确认
+    // sack_blocks 为对端的 SACK 块，带 SACK 块的确认只有报告了新的 SACK 数据时才算重复确认
+    // ts_echo 为对端回显的时间戳（TSecr），有值时确认新数据的 ACK 都用它采样 RTT，重传的段也不例外
+    bool ack_received(const WrappingInt32 ackno,
+                      const size_t window_size,
+                      const bool pure_ack = true,
+                      const TCPHeader::SACKBlocks &sack_blocks = {},
+                      const std::optional<uint32_t> ts_echo = {});
+
+    // 本端的时间戳时钟（TSval）：毫秒时钟加上 ISN 作为每个连接不同的起点
+    uint32_t ts_value() const { return static_cast<uint32_t>(_clock + _isn.raw_value()); }
 
     // 生成一个空负载的 TCP 段，用于创建空的 ACK 段
     void send_empty_segment();
@@ -93,6 +250,47 @@ class TCPSender {
     // 返回连续重传的次数
     unsigned int consecutive_retransmissions() const;
 
+    // 对端 SYN 中的 MSS 选项：段大小不超过它，并按新的 MSS 重新开始拥塞控制（握手期间还没有发送数据）
+    void set_peer_mss(const size_t mss);
+    // 当前的段大小，以及它的上限
+    size_t mss() const { return _mss; }
+    size_t max_mss() const { return _max_mss; }
+    // 之后发出的段要带上的选项字节数，由连接在填充窗口之前设置
+    void set_option_space(const size_t bytes) { _option_space = bytes; }
+
+    // 返回当前的拥塞窗口（字节），没有拥塞控制时为 SIZE_MAX
+    size_t congestion_window() const { return _cc ? _cc->cwnd() : SIZE_MAX; }
+
+    // 是否处于快速恢复
+    bool in_fast_recovery() const { return _in_recovery; }
+
+    // 已被 SACK 的字节数，以及按 RFC 6675 估计的在途字节数（pipe）
+    size_t sacked_bytes() const { return _sacked_bytes; }
+    size_t pipe_size() const { return pipe(); }
+
+    // 平滑 RTT 和 RTT 偏差（毫秒），还没有样本时 srtt 为空
+    std::optional<double> srtt() const { return _srtt; }
+    double rttvar() const { return _rttvar; }
+    // 当前的重传超时时间（毫秒，包括指数退避）
+    size_t retransmission_timeout() const { return _retransmission_timeout; }
+    // 设置 cork：开启时只发出满 MSS 的段（FIN 除外），关闭后下一次 fill_window 发出积攒的数据
+    void set_corked(const bool corked) { _corked = corked; }
+    bool corked() const { return _corked; }
+    // 是否有数据因为 Nagle、cork 或 autocork 被扣住
+    bool holding_data() const { return _holding; }
+    // 不管 Nagle、cork 和 autocork，立即发出被扣住的数据（cork 超时时调用）
+    void flush();
+
+    // 当前的 pacing 速率（字节/毫秒），为空时不做 pacing，窗口允许的段立即发出
+    std::optional<double> pacing_rate() const;
+    // 距离重传定时器到期还有多少毫秒，定时器没有运行时为空
+    std::optional<size_t> time_until_retransmission() const;
+    // 有数据因为 pacing 额度不足而等待时，距离额度够发下一个段还有多少毫秒，否则为空
+    std::optional<size_t> time_until_next_send() const;
+
+    // 返回拥塞控制模块，没有拥塞控制时为空
+    const CongestionControl *congestion_control() const { return _cc.get(); }
+
     // 返回待发送的 TCP 段的队列，这些段需要由 TCPConnection 出队并发送
     std::queue<TCPSegment> &segments_out() { return _segments_out; }
     // 返回下一个待发送字节的绝对序列号
@@ -7,11 +7,21 @@ void Buffer::remove_prefix(const size_t n) {
         throw out_of_range("Buffer::remove_prefix");
     }
     _starting_offset += n;
-    if (_storage and _starting_offset == _storage->size()) {
+    _length -= n;
+    if (_storage and _length == 0) {
         _storage.reset();
     }
 }
 
+Buffer Buffer::prefix(const size_t n) const {
+    if (n > str().size()) {
+        throw out_of_range("Buffer::prefix");
+    }
+    Buffer ret = *this;
+    ret._length = n;
+    return ret;
+}
+
 void BufferList::append(const BufferList &other) {
     for (const auto &buf : other._buffers) {
         _buffers.push_back(buf);
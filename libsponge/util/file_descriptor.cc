@@ -73,6 +73,39 @@ string FileDescriptor::read(const size_t limit) {
     return ret;
 }
 
+//! \param[in] buffers is the array of regions to fill, in order
+//! \param[in] count is the number of regions in `buffers`
+//! \returns the number of bytes read (EOF is recorded if the regions were non-empty and nothing was read)
+size_t FileDescriptor::readv(const iovec *buffers, const size_t count) {
+    size_t size_to_read = 0;
+    for (size_t i = 0; i < count; i++) {
+        size_to_read += buffers[i].iov_len;
+    }
+
+    const ssize_t bytes_read = SystemCall("readv", ::readv(fd_num(), buffers, count));
+    if (size_to_read > 0 && bytes_read == 0) {
+        _internal_fd->_eof = true;
+    }
+    if (bytes_read > static_cast<ssize_t>(size_to_read)) {
+        throw runtime_error("readv() read more than requested");
+    }
+
+    register_read();
+
+    return bytes_read;
+}
+
+//! \param[in] buffers is the array of regions to write, in order
+//! \param[in] count is the number of regions in `buffers`
+//! \returns the number of bytes written, which may be short if the fd is non-blocking
+size_t FileDescriptor::writev(const iovec *buffers, const size_t count) {
+    const ssize_t bytes_written = SystemCall("writev", ::writev(fd_num(), buffers, count));
+
+    register_write();
+
+    return bytes_written;
+}
+
 size_t FileDescriptor::write(BufferViewList buffer, const bool write_all) {
     size_t total_bytes_written = 0;
 
@@ -7,6 +7,8 @@
 #include <cstddef>
 #include <limits>
 #include <memory>
+#include <sys/uio.h>
+#include <vector>
 
 //! A reference-counted handle to a file descriptor
 class FileDescriptor {
@@ -61,6 +63,12 @@ class FileDescriptor {
     //! Read up to `limit` bytes into `str` (caller can allocate storage)
     void read(std::string &str, const size_t limit = std::numeric_limits<size_t>::max());
 
+    //! Read into caller-owned storage with a single [readv(2)](\ref man2::readv); returns the number of bytes read
+    size_t readv(const iovec *buffers, const size_t count);
+
+    //! Write caller-owned storage with a single [writev(2)](\ref man2::writev); returns the number of bytes written
+    size_t writev(const iovec *buffers, const size_t count);
+
     //! Write a string, possibly blocking until all is written
     size_t write(const char *str, const bool write_all = true) { return write(BufferViewList(str), write_all); }
 
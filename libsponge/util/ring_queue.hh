@@ -0,0 +1,66 @@
+#ifndef SPONGE_LIBSPONGE_RING_QUEUE_HH
+#define SPONGE_LIBSPONGE_RING_QUEUE_HH
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+//! \brief A FIFO queue kept in one contiguous array whose size is a power of two
+//! \details Elements are addressed by their position from the front, so a scan touches consecutive
+//! memory (wrapping around at most once) and indexing is an add and a mask. The array doubles when
+//! full and never shrinks; popped slots are reset so they do not keep resources alive.
+template <typename T>
+class RingQueue {
+  private:
+    std::vector<T> _slots{};
+    size_t _head = 0;
+    size_t _size = 0;
+
+    size_t slot(const size_t i) const { return (_head + i) & (_slots.size() - 1); }
+
+    void grow() {
+        std::vector<T> slots(std::max<size_t>(2 * _slots.size(), 16));
+        for (size_t i = 0; i < _size; ++i) {
+            slots[i] = std::move(_slots[slot(i)]);
+        }
+        _slots = std::move(slots);
+        _head = 0;
+    }
+
+  public:
+    bool empty() const { return _size == 0; }
+    size_t size() const { return _size; }
+
+    //! \name Access by position, 0 being the front
+    //!@{
+    T &operator[](const size_t i) { return _slots[slot(i)]; }
+    const T &operator[](const size_t i) const { return _slots[slot(i)]; }
+    T &front() { return (*this)[0]; }
+    const T &front() const { return (*this)[0]; }
+    T &back() { return (*this)[_size - 1]; }
+    const T &back() const { return (*this)[_size - 1]; }
+    //!@}
+
+    void push_back(T value) {
+        if (_size == _slots.size()) {
+            grow();
+        }
+        _slots[slot(_size)] = std::move(value);
+        ++_size;
+    }
+
+    void pop_front() {
+        _slots[_head] = T{};
+        _head = slot(1);
+        --_size;
+    }
+
+    void clear() {
+        while (!empty()) {
+            pop_front();
+        }
+    }
+};
+
+#endif  // SPONGE_LIBSPONGE_RING_QUEUE_HH
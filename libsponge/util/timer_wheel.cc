@@ -0,0 +1,98 @@
+#include "timer_wheel.hh"
+
+#include "util.hh"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+using namespace std;
+
+TimerWheel::TimerWheel(const size_t timers, const size_t slots, const uint64_t granularity_ms)
+    : _timers(timers), _slots(), _granularity(granularity_ms) {
+    if (slots == 0 or granularity_ms == 0) {
+        throw invalid_argument("TimerWheel: slots and granularity must be positive");
+    }
+    _slots.assign(round_up_pow2(slots), NONE);
+}
+
+void TimerWheel::link(const TimerId id) {
+    Timer &timer = _timers[id];
+    // an overdue timer goes in the current slot, which the next advance() visits first
+    timer.slot = slot_of(max(timer.deadline, _now));
+    size_t &head = _slots[timer.slot];
+    timer.prev = NONE;
+    timer.next = head;
+    if (head != NONE) {
+        _timers[head].prev = id;
+    }
+    head = id;
+    timer.armed = true;
+}
+
+void TimerWheel::unlink(const TimerId id) {
+    Timer &timer = _timers[id];
+    if (timer.prev != NONE) {
+        _timers[timer.prev].next = timer.next;
+    } else {
+        _slots[timer.slot] = timer.next;
+    }
+    if (timer.next != NONE) {
+        _timers[timer.next].prev = timer.prev;
+    }
+    timer.prev = timer.next = NONE;
+    timer.armed = false;
+}
+
+void TimerWheel::arm(const TimerId id, const uint64_t deadline) {
+    if (_timers.at(id).armed) {
+        unlink(id);
+    }
+    _timers[id].deadline = deadline;
+    link(id);
+}
+
+void TimerWheel::disarm(const TimerId id) {
+    if (_timers.at(id).armed) {
+        unlink(id);
+    }
+}
+
+void TimerWheel::advance(const uint64_t ms, const function<void(TimerId)> &fire) {
+    const uint64_t later = _now + ms;
+    const uint64_t ticks = min<uint64_t>(later / _granularity - _now / _granularity + 1, _slots.size());
+
+    vector<pair<uint64_t, TimerId>> expired{};
+    for (uint64_t i = 0; i < ticks; ++i) {
+        for (size_t id = _slots[slot_of(_now + i * _granularity)]; id != NONE; id = _timers[id].next) {
+            if (_timers[id].deadline <= later) {
+                expired.emplace_back(_timers[id].deadline, id);
+            }
+        }
+    }
+    for (const auto &[deadline, id] : expired) {
+        unlink(id);
+    }
+    _now = later;
+
+    sort(expired.begin(), expired.end());
+    for (const auto &[deadline, id] : expired) {
+        // a callback that re-armed this timer has replaced the expiry
+        if (not _timers[id].armed) {
+            fire(id);
+        }
+    }
+}
+
+optional<uint64_t> TimerWheel::time_until_next() const {
+    optional<uint64_t> earliest{};
+    for (const auto &timer : _timers) {
+        if (timer.armed and (not earliest.has_value() or timer.deadline < *earliest)) {
+            earliest = timer.deadline;
+        }
+    }
+    if (not earliest.has_value()) {
+        return nullopt;
+    }
+    return *earliest > _now ? *earliest - _now : 0;
+}
@@ -0,0 +1,67 @@
+#ifndef SPONGE_LIBSPONGE_TIMER_WHEEL_HH
+#define SPONGE_LIBSPONGE_TIMER_WHEEL_HH
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <vector>
+
+//! \brief A hashed timing wheel holding a fixed set of one-shot timers, each named by a small integer
+//! \details Time advances in milliseconds and is divided into ticks of `granularity` ms. Each armed timer
+//! sits in the slot of its deadline tick, linked into that slot's list through the timer array, so arming,
+//! re-arming and disarming are O(1). Advancing visits only the slots the clock passes (at most one turn of
+//! the wheel); a deadline more than one turn ahead stays in its slot until the clock actually reaches it.
+class TimerWheel {
+  public:
+    using TimerId = size_t;
+
+  private:
+    static constexpr size_t NONE = SIZE_MAX;
+
+    struct Timer {
+        uint64_t deadline = 0;
+        size_t slot = 0;
+        size_t prev = NONE;
+        size_t next = NONE;
+        bool armed = false;
+    };
+
+    std::vector<Timer> _timers;
+    std::vector<size_t> _slots;  //!< head of each slot's list of timers
+    uint64_t _granularity;
+    uint64_t _now = 0;
+
+    size_t slot_of(const uint64_t time) const { return (time / _granularity) & (_slots.size() - 1); }
+    void link(const TimerId id);
+    void unlink(const TimerId id);
+
+  public:
+    //! \param[in] timers is the number of timers, with ids `0` to `timers - 1`
+    //! \param[in] slots is the number of slots, rounded up to a power of two
+    //! \param[in] granularity_ms is the length of one tick in milliseconds
+    explicit TimerWheel(const size_t timers, const size_t slots = 256, const uint64_t granularity_ms = 1);
+
+    //! \brief The wheel's clock in milliseconds, starting at zero
+    uint64_t now() const { return _now; }
+
+    //! \brief Arm (or re-arm) timer `id` to expire at absolute time `deadline`
+    //! \note A deadline that has already passed expires on the next call to advance()
+    void arm(const TimerId id, const uint64_t deadline);
+
+    //! \brief Stop timer `id`; does nothing if it is not armed
+    void disarm(const TimerId id);
+
+    bool armed(const TimerId id) const { return _timers.at(id).armed; }
+
+    //! \brief Move the clock forward by `ms` and call `fire` once for every timer that expired,
+    //! earliest deadline first. Expired timers are disarmed before `fire` is called, so `fire` may re-arm them.
+    void advance(const uint64_t ms, const std::function<void(TimerId)> &fire);
+
+    //! \brief Milliseconds until the earliest armed timer expires (zero if it is already due),
+    //! or empty if no timer is armed
+    //! \note Linear in the number of timers, which is meant to be a handful per owner
+    std::optional<uint64_t> time_until_next() const;
+};
+
+#endif  // SPONGE_LIBSPONGE_TIMER_WHEEL_HH
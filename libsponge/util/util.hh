@@ -51,6 +51,9 @@ std::mt19937 get_random_generator();
 //! Get the time in milliseconds since the program began.
 uint64_t timestamp_ms();
 
+//! The smallest power of two that is at least `n` (and at least 1), e.g. for ring buffers indexed with a mask
+size_t round_up_pow2(const size_t n);
+
 //! The internet checksum algorithm
 class InternetChecksum {
   private:
@@ -0,0 +1,119 @@
+#include "byte_stream.hh"
+#include "byte_stream_test_harness.hh"
+#include "util.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+static string concat(const BufferViewList &views) {
+    string ret;
+    for (const auto &iov : views.as_iovecs()) {
+        ret.append(static_cast<const char *>(iov.iov_base), iov.iov_len);
+    }
+    return ret;
+}
+
+int main() {
+    try {
+        {
+            ByteStreamTestHarness test{"chunked overwrite-pop-overwrite", 2, ByteStream::Mode::Chunked};
+
+            test.execute(Write{"cat"}.with_bytes_written(2));
+            test.execute(Peek{"ca"});
+            test.execute(Pop{1});
+            test.execute(Write{"tac"}.with_bytes_written(1));
+
+            test.execute(BytesRead{1});
+            test.execute(BytesWritten{3});
+            test.execute(RemainingCapacity{0});
+            test.execute(BufferSize{2});
+            test.execute(Peek{"at"});
+        }
+
+        {
+            ByteStreamTestHarness test{"chunked pop across chunks", 15, ByteStream::Mode::Chunked};
+
+            test.execute(Write{"abc"}.with_bytes_written(3));
+            test.execute(Write{"defg"}.with_bytes_written(4));
+            test.execute(Write{"hi"}.with_bytes_written(2));
+            test.execute(Pop{5});
+            test.execute(Peek{"fghi"});
+            test.execute(EndInput{});
+            test.execute(Pop{4});
+            test.execute(Eof{true});
+            test.execute(BytesRead{9});
+        }
+
+        // a read within one chunk shares the chunk's storage; a read across chunks is copied
+        {
+            ByteStream stream{100, ByteStream::Mode::Chunked};
+            const Buffer data{string("abcdefgh")};
+            stream.write(data);
+            const Buffer first = stream.read_buffer(3);
+            if (first.str() != "abc" or first.str().data() != data.str().data()) {
+                throw runtime_error("read_buffer within a chunk should share its storage");
+            }
+            stream.write("ij");
+            if (stream.read_buffer(100).str() != "defghij" or not stream.buffer_empty()) {
+                throw runtime_error("read_buffer across chunks does not match what was written");
+            }
+        }
+
+        // randomized comparison of both modes against a plain string
+        auto rd = get_random_generator();
+        for (const auto mode : {ByteStream::Mode::Ring, ByteStream::Mode::Chunked}) {
+            const size_t capacity = 1 + rd() % 3000;
+            ByteStream stream{capacity, mode};
+            string model;
+            for (size_t i = 0; i < 5000; i++) {
+                string d(rd() % 400, 0);
+                generate(d.begin(), d.end(), [&] { return 'a' + (rd() % 26); });
+                const size_t expected = min(d.size(), capacity - model.size());
+                const size_t written = (i % 2) ? stream.write(d) : stream.write(Buffer(string(d)));
+                if (written != expected) {
+                    throw runtime_error("wrote " + to_string(written) + " bytes, expected " + to_string(expected));
+                }
+                model.append(d.substr(0, written));
+
+                const size_t peek_len = rd() % (model.size() + 1);
+                if (concat(stream.peek_buffers(peek_len)) != model.substr(0, peek_len) or
+                    stream.peek_output(peek_len) != model.substr(0, peek_len)) {
+                    throw runtime_error("peeked data does not match what was written");
+                }
+
+                const auto [first, second] = stream.peek_spans();
+                if (model.compare(0, first.size(), first) != 0 or
+                    model.compare(first.size(), second.size(), second) != 0) {
+                    throw runtime_error("peek_spans does not match what was written");
+                }
+
+                size_t pop_len = rd() % (model.size() + 1);
+                if (i % 3 == 0) {
+                    string dst(pop_len, 0);
+                    pop_len = stream.read_into(dst.data(), pop_len);
+                    if (dst != model.substr(0, pop_len)) {
+                        throw runtime_error("read_into does not match what was written");
+                    }
+                } else if (i % 3 == 1) {
+                    const Buffer read = stream.read_buffer(pop_len);
+                    if (read.str() != model.substr(0, pop_len)) {
+                        throw runtime_error("read_buffer does not match what was written");
+                    }
+                } else {
+                    stream.pop_output(pop_len);
+                }
+                model.erase(0, pop_len);
+                if (stream.buffer_size() != model.size()) {
+                    throw runtime_error("buffer_size does not match");
+                }
+            }
+        }
+    } catch (const exception &e) {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,74 @@
+#include "concurrent_byte_stream.hh"
+#include "util.hh"
+
+#include <exception>
+#include <iostream>
+#include <poll.h>
+#include <thread>
+
+using namespace std;
+
+// one writer thread pushes `data` in random-sized pieces; the reader checks it arrives intact
+static void run(const string &test_name, const string &data, const size_t capacity, const bool use_eventfd) {
+    ConcurrentByteStream stream{capacity, use_eventfd};
+
+    thread writer([&] {
+        auto rd = get_random_generator();
+        size_t offset = 0;
+        while (offset < data.size()) {
+            if (use_eventfd and stream.remaining_capacity() == 0) {
+                pollfd pfd{stream.writable_event().fd_num(), POLLIN, 0};
+                SystemCall("poll", ::poll(&pfd, 1, -1));
+                ConcurrentByteStream::clear_event(stream.writable_event());
+                continue;
+            }
+            const size_t written = stream.write(data.substr(offset, 1 + rd() % 5000));
+            if (written == 0) {
+                this_thread::yield();
+            }
+            offset += written;
+        }
+        stream.end_input();
+    });
+
+    string received;
+    auto rd = get_random_generator();
+    while (not stream.eof()) {
+        if (use_eventfd and stream.buffer_empty() and not stream.input_ended()) {
+            pollfd pfd{stream.readable_event().fd_num(), POLLIN, 0};
+            SystemCall("poll", ::poll(&pfd, 1, -1));
+            ConcurrentByteStream::clear_event(stream.readable_event());
+            continue;
+        }
+        if (stream.buffer_empty()) {
+            this_thread::yield();
+            continue;
+        }
+        received.append(stream.read(1 + rd() % 7000));
+    }
+    writer.join();
+
+    if (received != data) {
+        throw runtime_error(test_name + ": bytes received do not match bytes written");
+    }
+    if (stream.bytes_written() != data.size() or stream.bytes_read() != data.size()) {
+        throw runtime_error(test_name + ": byte counts do not match");
+    }
+}
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+        string data(8 * 1024 * 1024, 0);
+        generate(data.begin(), data.end(), [&] { return rd(); });
+
+        run("spin, small capacity", data, 1000, false);
+        run("spin, large capacity", data, 65536, false);
+        run("eventfd wakeups", data, 4096, true);
+    } catch (const exception &e) {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,99 @@
+#include "byte_stream.hh"
+#include "file_descriptor.hh"
+#include "test_err_if.hh"
+#include "test_should_be.hh"
+#include "util.hh"
+
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+#include <utility>
+
+using namespace std;
+
+static pair<FileDescriptor, FileDescriptor> make_pipe() {
+    int fds[2];
+    SystemCall("pipe", ::pipe(static_cast<int *>(fds)));
+    return {FileDescriptor(fds[0]), FileDescriptor(fds[1])};
+}
+
+// read exactly `len` bytes from a blocking fd
+static string read_exactly(FileDescriptor &fd, const size_t len) {
+    string ret;
+    while (ret.size() < len) {
+        const string chunk = fd.read(len - ret.size());
+        test_err_if(chunk.empty(), "the pipe ended early");
+        ret.append(chunk);
+    }
+    return ret;
+}
+
+static string pattern(const size_t len, const size_t offset = 0) {
+    string ret(len, 0);
+    for (size_t i = 0; i < len; ++i) {
+        ret[i] = static_cast<char>('a' + (offset + i) % 26);
+    }
+    return ret;
+}
+
+int main() {
+    try {
+        // in Ring mode, a read and a write that cross the end of the buffer each use both iovecs
+        {
+            ByteStream stream{8};
+            stream.write("abcdef");
+            stream.pop_output(6);
+            auto [in_r, in_w] = make_pipe();
+            in_w.write("0123456789");
+            test_should_be(stream.read_from_fd(in_r, 100), size_t{8});
+            const auto [first, second] = stream.peek_spans();
+            test_should_be(first.size(), size_t{2});
+            test_should_be(second.size(), size_t{6});
+            test_err_if(stream.peek_output(8) != "01234567", "readv should fill the free space in order");
+
+            auto [out_r, out_w] = make_pipe();
+            test_should_be(stream.write_to_fd(out_w, 100), size_t{8});
+            test_err_if(not stream.buffer_empty(), "everything written should be popped");
+            test_err_if(read_exactly(out_r, 8) != "01234567", "writev should send both spans in order");
+        }
+
+        for (const auto mode : {ByteStream::Mode::Ring, ByteStream::Mode::Chunked}) {
+            // a short write on a non-blocking fd pops only what was written
+            {
+                constexpr size_t capacity = 1 << 18;
+                ByteStream stream{capacity, mode};
+                stream.write(Buffer(pattern(1000)));
+                stream.pop_output(1000);
+                stream.write(Buffer(pattern(capacity, 1000)));
+                auto [r, w] = make_pipe();
+                w.set_blocking(false);
+                const size_t written = stream.write_to_fd(w, capacity);
+                test_err_if(written == 0 or written >= capacity, "the pipe should take only part of the data");
+                test_should_be(stream.buffer_size(), capacity - written);
+                test_should_be(stream.bytes_read(), 1000 + written);
+                test_err_if(read_exactly(r, written) != pattern(written, 1000), "wrong bytes written");
+                test_err_if(stream.peek_output(100) != pattern(100, 1000 + written), "wrong bytes left");
+            }
+
+            // EOF is seen once the writer is gone and the pipe is drained
+            {
+                ByteStream stream{100, mode};
+                auto [r, w] = make_pipe();
+                w.write("hello");
+                w.close();
+                test_should_be(stream.read_from_fd(r, 100), size_t{5});
+                test_err_if(r.eof(), "EOF should not be reported while data was read");
+                test_should_be(stream.read_from_fd(r, 100), size_t{0});
+                test_err_if(not r.eof(), "an empty read should report EOF");
+                test_err_if(stream.read(100) != "hello", "the data should arrive intact");
+            }
+        }
+    } catch (const exception &e) {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
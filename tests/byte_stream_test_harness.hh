@@ -134,7 +134,9 @@ class ByteStreamTestHarness {
     std::vector<std::string> _steps_executed{};
 
   public:
-    ByteStreamTestHarness(const std::string &test_name, const size_t capacity);
+    ByteStreamTestHarness(const std::string &test_name,
+                          const size_t capacity,
+                          const ByteStream::Mode mode = ByteStream::Mode::Ring);
 
     void execute(const ByteStreamTestStep &step);
 };
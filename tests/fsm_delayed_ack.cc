@@ -0,0 +1,117 @@
+#include "tcp_config.hh"
+#include "tcp_connection.hh"
+#include "tcp_pair_harness.hh"
+#include "test_should_be.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <utility>
+
+using namespace std;
+
+int main() {
+    try {
+        TCPConfig cfg;
+        TCPConfig delaying = cfg;
+        delaying.delayed_ack = true;
+
+        {
+            TCPConnection client{cfg}, server{delaying};
+            handshake(client, server);
+
+            // a single segment is acknowledged after the timeout
+            client.write("hello");
+            deliver(client, server);
+            test_err_if(not server.segments_out().empty(), "the ACK should be delayed");
+            test_should_be(server.time_until_next_timer(), optional<size_t>{TCPConfig::DELAYED_ACK_DFLT});
+            server.tick(TCPConfig::DELAYED_ACK_DFLT - 1);
+            test_err_if(not server.segments_out().empty(), "not before the timeout");
+            server.tick(1);
+            test_err_if(server.segments_out().size() != 1, "the delayed ACK goes out at the timeout");
+            deliver(server, client);
+            test_should_be(client.bytes_in_flight(), size_t{0});
+
+            // every second segment is acknowledged at once
+            client.write(string(4 * TCPConfig::MAX_PAYLOAD_SIZE, 'x'));
+            // two ACKs for four segments
+            test_should_be(deliver(client, server).segments, size_t{4});
+            test_should_be(server.segments_out().size(), size_t{2});
+            deliver(server, client);
+            test_err_if(client.bytes_in_flight() != 0 or server.time_until_next_timer().has_value(),
+                        "nothing is left to acknowledge");
+
+            // outgoing data carries the ACK instead
+            client.write("ping");
+            deliver(client, server);
+            server.write("pong");
+            test_err_if(server.segments_out().size() != 1 or server.segments_out().front().payload().size() != 4,
+                        "the reply carries the ACK");
+            deliver(server, client);
+            server.tick(TCPConfig::DELAYED_ACK_DFLT);
+            test_err_if(not server.segments_out().empty(), "no separate ACK follows");
+            deliver(client, server);
+            server.tick(TCPConfig::DELAYED_ACK_DFLT);
+            deliver(server, client);
+
+            // out-of-order data, and the data that fills the hole, are acknowledged at once
+            client.write(string(2 * TCPConfig::MAX_PAYLOAD_SIZE, 'y'));
+            deliver(client, server, drop_indices({0}));
+            test_err_if(server.segments_out().size() != 1, "out-of-order data is acknowledged at once");
+            deliver(server, client);
+            client.tick(client.time_until_next_timer().value());
+            deliver(client, server);
+            test_err_if(server.segments_out().size() != 1, "filling the hole is acknowledged at once");
+            deliver(server, client);
+            test_should_be(client.bytes_in_flight(), size_t{0});
+
+            // so is a FIN
+            client.end_input_stream();
+            deliver(client, server);
+            test_err_if(server.segments_out().size() != 1, "a FIN is acknowledged at once");
+        }
+
+        {
+            // reading from a full receive window sends a window update
+            TCPConfig small = delaying;
+            small.recv_capacity = 4000;
+            TCPConnection client{cfg}, server{small};
+            handshake(client, server);
+            client.write(string(4000, 'x'));
+            deliver(client, server);
+            deliver(server, client);
+            // the window is full
+            test_should_be(server.inbound_stream().buffer_size(), size_t{4000});
+            server.inbound_stream_consumed();
+            test_err_if(not server.segments_out().empty(), "nothing was read, so no update");
+            server.inbound_stream().pop_output(4000);
+            server.inbound_stream_consumed();
+            test_err_if(server.segments_out().size() != 1 or server.segments_out().front().header().win != 4000,
+                        "the window update advertises the open window");
+        }
+
+        // reading each segment as it arrives, the way the socket does, opens the window by only one segment
+        // each time; the next ACK carries that, so reads add no ACKs of their own
+        for (const auto &[config, acks] : {make_pair(cfg, size_t{20}), make_pair(delaying, size_t{10})}) {
+            TCPConnection client{cfg}, server{config};
+            handshake(client, server);
+            size_t sent = 0;
+            for (size_t i = 0; i < 20; ++i) {
+                client.write(string(TCPConfig::MAX_PAYLOAD_SIZE, 'x'));
+                deliver(client, server);
+                server.inbound_stream().pop_output(server.inbound_stream().buffer_size());
+                server.inbound_stream_consumed();
+                sent += deliver(server, client).segments;
+            }
+            test_should_be(sent, acks);
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
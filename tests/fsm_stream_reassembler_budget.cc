@@ -0,0 +1,139 @@
+#include "byte_stream.hh"
+#include "stream_reassembler.hh"
+#include "test_err_if.hh"
+#include "test_should_be.hh"
+#include "util.hh"
+
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+int main() {
+    try {
+        for (const auto mode : {StreamReassembler::Mode::IntervalMap, StreamReassembler::Mode::Ring}) {
+            // per-reassembler byte limit keeps the bytes nearest the head
+            {
+                StreamReassembler r{100, mode};
+                r.set_limits(6);
+                r.push_substring("bcd", 1, false);
+                r.push_substring("ghij", 6, false);
+                test_should_be(r.unassembled_bytes(), size_t{6});
+                test_should_be(r.evicted_bytes(), size_t{1});
+                test_should_be(r.evictions(), size_t{1});
+                r.push_substring("a", 0, false);
+                test_err_if(r.stream_out().read(4) != "abcd", "near bytes were evicted");
+                r.push_substring("ef", 4, false);
+                test_err_if(r.stream_out().read(100) != "efghi", "farthest byte was not the one evicted");
+                test_should_be(r.unassembled_bytes(), size_t{0});
+            }
+
+            // lowering the limit prunes what is already buffered
+            {
+                StreamReassembler r{100, mode};
+                r.push_substring("xyz", 50, false);
+                r.push_substring("b", 1, false);
+                r.set_limits(1);
+                test_should_be(r.unassembled_bytes(), size_t{1});
+                test_should_be(r.evicted_bytes(), size_t{3});
+                r.push_substring("a", 0, false);
+                test_err_if(r.stream_out().read(100) != "ab", "wrong bytes kept");
+            }
+
+            // the shared budget is split between reassemblers and released on destruction
+            {
+                auto budget = make_shared<StreamReassembler::SharedBudget>();
+                budget->max_bytes = 8;
+                StreamReassembler r1{100, mode};
+                r1.set_limits(numeric_limits<size_t>::max(), numeric_limits<size_t>::max(), budget);
+                r1.push_substring("bcdef", 1, false);
+                test_should_be(budget->used_bytes.load(), size_t{5});
+                {
+                    StreamReassembler r2{100, mode};
+                    r2.set_limits(numeric_limits<size_t>::max(), numeric_limits<size_t>::max(), budget);
+                    r2.push_substring("bcdef", 1, false);
+                    test_should_be(r2.unassembled_bytes(), size_t{3});
+                    test_should_be(budget->used_bytes.load(), size_t{8});
+                    test_should_be(budget->evicted_bytes.load(), size_t{2});
+                    r2.push_substring("a", 0, false);
+                    test_err_if(r2.stream_out().read(100) != "abcd", "wrong bytes kept under shared budget");
+                    test_should_be(budget->used_bytes.load(), size_t{5});
+                }
+                test_should_be(budget->used_bytes.load(), size_t{5});
+                r1.push_substring("a", 0, false);
+                test_should_be(budget->used_bytes.load(), size_t{0});
+            }
+        }
+
+        // the fragment limit drops whole fragments, farthest first
+        {
+            StreamReassembler r{100};
+            r.set_limits(numeric_limits<size_t>::max(), 2);
+            r.push_substring("b", 1, false);
+            r.push_substring("d", 3, false);
+            r.push_substring("ff", 5, false);
+            test_should_be(r.unassembled_bytes(), size_t{2});
+            test_should_be(r.evicted_bytes(), size_t{2});
+            r.push_substring("a", 0, false);
+            r.push_substring("c", 2, false);
+            r.push_substring("e", 4, false);
+            test_err_if(r.stream_out().read(100) != "abcde", "wrong fragments kept");
+        }
+
+        // so does the shared fragment budget, counting the fragments of every reassembler
+        {
+            auto budget = make_shared<StreamReassembler::SharedBudget>();
+            budget->max_fragments = 3;
+            StreamReassembler r1{100}, r2{100};
+            r1.set_limits(numeric_limits<size_t>::max(), numeric_limits<size_t>::max(), budget);
+            r2.set_limits(numeric_limits<size_t>::max(), numeric_limits<size_t>::max(), budget);
+            r1.push_substring("b", 1, false);
+            r1.push_substring("d", 3, false);
+            test_should_be(budget->used_fragments.load(), size_t{2});
+            r2.push_substring("b", 1, false);
+            r2.push_substring("d", 3, false);
+            test_should_be(r2.unassembled_bytes(), size_t{1});
+            test_should_be(budget->used_fragments.load(), size_t{3});
+            r1.push_substring("a", 0, false);
+            test_should_be(budget->used_fragments.load(), size_t{2});
+        }
+
+        // reassemblers on different threads share one budget without losing updates
+        {
+            auto budget = make_shared<StreamReassembler::SharedBudget>();
+            budget->max_bytes = 1000;
+            vector<thread> threads;
+            for (size_t t = 0; t < 4; ++t) {
+                threads.emplace_back([budget] {
+                    StreamReassembler r{1000};
+                    r.set_limits(numeric_limits<size_t>::max(), numeric_limits<size_t>::max(), budget);
+                    for (size_t i = 0; i < 20000; ++i) {
+                        const size_t head = r.head_index();
+                        r.push_substring("x", head + 1 + i * 7 % 900, false);
+                        // now and then fill the gap, so the fragments are assembled and give their bytes back
+                        if (i % 100 == 99) {
+                            r.push_substring(string(1000, 'x'), head, false);
+                            r.stream_out().pop_output(r.stream_out().buffer_size());
+                        }
+                    }
+                });
+            }
+            for (auto &t : threads) {
+                t.join();
+            }
+            test_should_be(budget->used_bytes.load(), size_t{0});
+            test_should_be(budget->used_fragments.load(), size_t{0});
+        }
+    } catch (const exception &e) {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -103,6 +103,27 @@ struct UnassembledBytes : public ReassemblerExpectation {
     }
 };
 
+struct PathCounts : public ReassemblerExpectation {
+    uint64_t _fast, _slow;
+
+    PathCounts(uint64_t fast, uint64_t slow) : _fast(fast), _slow(slow) {}
+    std::string description() const {
+        std::ostringstream ss;
+        ss << "fast path segments = " << _fast << ", slow path segments = " << _slow;
+        return ss.str();
+    }
+
+    void execute(StreamReassembler &reassembler) const {
+        if (reassembler.fast_path_segments() != _fast or reassembler.slow_path_segments() != _slow) {
+            std::ostringstream ss;
+            ss << "The reassembler was expected to take the fast path `" << _fast << "` times and the slow path `"
+               << _slow << "` times, but took them `" << reassembler.fast_path_segments() << "` and `"
+               << reassembler.slow_path_segments() << "` times";
+            throw ReassemblerExpectationViolation(ss.str());
+        }
+    }
+};
+
 struct AtEof : public ReassemblerExpectation {
     AtEof() {}
     std::string description() const {
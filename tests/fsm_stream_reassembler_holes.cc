@@ -29,6 +29,7 @@ int main() {
             test.execute(BytesAssembled(2));
             test.execute(BytesAvailable("ab"));
             test.execute(NotAtEof{});
+            test.execute(PathCounts(0, 2));
         }
 
         {
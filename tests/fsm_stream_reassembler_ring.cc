@@ -0,0 +1,68 @@
+#include "byte_stream.hh"
+#include "stream_reassembler.hh"
+#include "util.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+
+using namespace std;
+
+static constexpr unsigned NREPS = 64;
+static constexpr unsigned NSEGS = 2000;
+
+// feed identical random (overlapping, duplicated, out-of-window) segments to both modes and compare
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        for (unsigned rep_no = 0; rep_no < NREPS; ++rep_no) {
+            // small capacities make the ring wrap on almost every segment
+            const size_t capacity = 1 + rd() % (rep_no % 2 ? 5000 : 16);
+            const size_t total = 20 * capacity;
+            string d(total, 0);
+            generate(d.begin(), d.end(), [&] { return rd(); });
+
+            StreamReassembler map_mode{capacity, StreamReassembler::Mode::IntervalMap};
+            StreamReassembler ring_mode{capacity, StreamReassembler::Mode::Ring};
+            string map_out, ring_out;
+
+            for (unsigned i = 0; i < NSEGS and not map_mode.stream_out().eof(); ++i) {
+                // segments start near the head, sometimes beyond the window
+                const size_t index = min(total - 1, map_mode.head_index() + rd() % (capacity + capacity / 4 + 1));
+                const size_t len = min(total - index, size_t(1 + rd() % (capacity / 2 + 1)));
+                const bool eof = index + len == total;
+                map_mode.push_substring(d.substr(index, len), index, eof);
+                ring_mode.push_substring(d.substr(index, len), index, eof);
+
+                if (map_mode.unassembled_bytes() != ring_mode.unassembled_bytes() or
+                    map_mode.head_index() != ring_mode.head_index()) {
+                    throw runtime_error("modes disagree on unassembled bytes or head index");
+                }
+
+                if (rd() % 2) {
+                    const size_t n = rd() % (map_mode.stream_out().buffer_size() + 1);
+                    map_out.append(map_mode.stream_out().read(n));
+                    ring_out.append(ring_mode.stream_out().read(n));
+                }
+            }
+            map_out.append(map_mode.stream_out().read(map_mode.stream_out().buffer_size()));
+            ring_out.append(ring_mode.stream_out().read(ring_mode.stream_out().buffer_size()));
+
+            if (map_out != ring_out or map_out != d.substr(0, map_out.size())) {
+                throw runtime_error("reassembled bytes are incorrect");
+            }
+            if (map_mode.stream_out().eof() != ring_mode.stream_out().eof()) {
+                throw runtime_error("modes disagree on eof");
+            }
+        }
+    } catch (const exception &e) {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -64,6 +64,8 @@ int main() {
 
                 test.execute(BytesAvailable("abcd"));
             }
+            // in-order traffic never touches the out-of-order storage
+            test.execute(PathCounts(100, 0));
         }
 
     } catch (const exception &e) {
@@ -13,6 +13,7 @@
 #include <optional>
 #include <sstream>
 #include <string>
+#include <vector>
 
 struct ReceiverTestStep {
     virtual std::string to_string() const { return "ReceiverTestStep"; }
@@ -84,6 +85,30 @@ struct ExpectWindow : public ReceiverExpectation {
     }
 };
 
+struct ExpectSackBlocks : public ReceiverExpectation {
+    TCPHeader::SACKBlocks _blocks;
+
+    ExpectSackBlocks(const TCPHeader::SACKBlocks &blocks) : _blocks(blocks) {}
+
+    static std::string blocks_string(const TCPHeader::SACKBlocks &blocks) {
+        std::ostringstream ss;
+        for (const auto &block : blocks) {
+            ss << " [" << block.left.raw_value() << ", " << block.right.raw_value() << ")";
+        }
+        return blocks.empty() ? " (none)" : ss.str();
+    }
+
+    std::string description() const { return "SACK blocks" + blocks_string(_blocks); }
+
+    void execute(TCPReceiver &receiver) const {
+        const auto reported = receiver.sack_blocks();
+        if (reported != _blocks) {
+            throw ReceiverExpectationViolation("The TCPReceiver reported SACK blocks" + blocks_string(reported) +
+                                               ", but they were expected to be" + blocks_string(_blocks));
+        }
+    }
+};
+
 struct ExpectUnassembledBytes : public ReceiverExpectation {
     size_t _n_bytes;
 
@@ -278,7 +303,8 @@ class TCPReceiverTestHarness {
     std::vector<std::string> steps_executed;
 
   public:
-    TCPReceiverTestHarness(size_t capacity) : receiver(capacity), steps_executed() {
+    TCPReceiverTestHarness(size_t capacity, StreamReassembler::Mode mode = StreamReassembler::Mode::IntervalMap)
+        : receiver(capacity, mode), steps_executed() {
         std::ostringstream ss;
         ss << "Initialized with ("
            << "capacity=" << capacity << ")";
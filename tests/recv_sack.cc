@@ -0,0 +1,101 @@
+#include "receiver_harness.hh"
+#include "tcp_connection.hh"
+#include "tcp_pair_harness.hh"
+#include "test_should_be.hh"
+#include "util.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        for (const auto mode : {StreamReassembler::Mode::IntervalMap, StreamReassembler::Mode::Ring}) {
+            uint32_t isn = uniform_int_distribution<uint32_t>{0, UINT32_MAX}(rd);
+            TCPReceiverTestHarness test{4000, mode};
+            // the block [isn + left, isn + right)
+            const auto block = [&](uint32_t left, uint32_t right) {
+                return TCPHeader::SACKBlock{WrappingInt32{isn + left}, WrappingInt32{isn + right}};
+            };
+            test.execute(SegmentArrives{}.with_syn().with_seqno(isn).with_result(SegmentArrives::Result::OK));
+            test.execute(ExpectSackBlocks{{}});
+
+            // each out-of-order segment reports its own block first, the rest follow in sequence order
+            test.execute(
+                SegmentArrives{}.with_seqno(isn + 11).with_data("klmn").with_result(SegmentArrives::Result::OK));
+            test.execute(ExpectSackBlocks{{block(11, 15)}});
+            test.execute(
+                SegmentArrives{}.with_seqno(isn + 31).with_data("EFGH").with_result(SegmentArrives::Result::OK));
+            test.execute(ExpectSackBlocks{{block(31, 35), block(11, 15)}});
+            test.execute(
+                SegmentArrives{}.with_seqno(isn + 21).with_data("uvwx").with_result(SegmentArrives::Result::OK));
+            test.execute(ExpectSackBlocks{{block(21, 25), block(11, 15), block(31, 35)}});
+
+            // adjacent data merges into one block; at most three blocks are reported
+            test.execute(SegmentArrives{}.with_seqno(isn + 15).with_data("op").with_result(SegmentArrives::Result::OK));
+            test.execute(ExpectSackBlocks{{block(11, 17), block(21, 25), block(31, 35)}});
+            test.execute(SegmentArrives{}.with_seqno(isn + 41).with_data("OP").with_result(SegmentArrives::Result::OK));
+            test.execute(ExpectSackBlocks{{block(41, 43), block(11, 17), block(21, 25)}});
+
+            // filling the first hole moves the ackno past the first block; in-order data is not a SACK block
+            test.execute(
+                SegmentArrives{}.with_seqno(isn + 1).with_data("abcdefghij").with_result(SegmentArrives::Result::OK));
+            test.execute(ExpectAckno{WrappingInt32{isn + 17}});
+            test.execute(ExpectSackBlocks{{block(41, 43), block(21, 25), block(31, 35)}});
+        }
+
+        {
+            TCPConfig cfg;
+            cfg.sack = true;
+            TCPConnection client{cfg}, server{cfg};
+            client.connect();
+            test_err_if(not client.segments_out().front().header().options.sack_permitted,
+                        "the SYN should offer SACK");
+            deliver(client, server);
+            test_err_if(not server.segments_out().front().header().options.sack_permitted,
+                        "the SYN-ACK should accept SACK");
+            deliver(server, client);
+            deliver(client, server);
+
+            // the second of three segments is lost: the ack for the third one SACKs it
+            client.write(string(3 * TCPConfig::MAX_PAYLOAD_SIZE, 'x'));
+            deliver(client, server, drop_indices({1}));
+            const auto &blocks = server.segments_out().back().header().options.sack_blocks;
+            test_should_be(blocks.size(), size_t{1});
+            test_should_be(blocks[0].right - blocks[0].left, int32_t(TCPConfig::MAX_PAYLOAD_SIZE));
+            test_should_be(server.unassembled_bytes(), TCPConfig::MAX_PAYLOAD_SIZE);
+        }
+
+        {
+            TCPConfig cfg;
+            cfg.sack = true;
+            TCPConnection client{TCPConfig{}}, server{cfg};
+            client.connect();
+            test_err_if(client.segments_out().front().header().options.sack_permitted, "SACK is off by default");
+            deliver(client, server);
+            test_err_if(server.segments_out().front().header().options.sack_permitted,
+                        "SACK should not be accepted unless offered");
+            deliver(server, client);
+            deliver(client, server);
+            client.write(string(3 * TCPConfig::MAX_PAYLOAD_SIZE, 'x'));
+            deliver(client, server, drop_indices({1}));
+            test_err_if(not server.segments_out().back().header().options.sack_blocks.empty(),
+                        "no SACK blocks without negotiation");
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,145 @@
+#include "tcp_connection.hh"
+#include "tcp_header.hh"
+#include "tcp_pair_harness.hh"
+#include "test_should_be.hh"
+#include "util.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <string>
+
+using namespace std;
+
+static TCPOptions::Timestamps timestamps_of(const TCPSegment &seg) {
+    test_err_if(not seg.header().options.timestamps.has_value(), "the segment should carry timestamps");
+    return *seg.header().options.timestamps;
+}
+
+int main() {
+    try {
+        TCPConfig cfg;
+        cfg.timestamps = true;
+
+        {
+            TCPConnection client{cfg}, server{cfg};
+            client.connect();
+            const auto syn_ts = timestamps_of(client.segments_out().front());
+            // the SYN has nothing to echo
+            test_should_be(syn_ts.echo_reply, uint32_t{0});
+            deliver(client, server);
+            const auto syn_ack_ts = timestamps_of(server.segments_out().front());
+            test_should_be(syn_ack_ts.echo_reply, syn_ts.value);
+            // the handshake takes 10 ms, the first RTT sample
+            client.tick(10);
+            deliver(server, client);
+            test_should_be(client.srtt(), optional<double>{10.0});
+            deliver(client, server);
+
+            // the first transmission is lost; the echo of the retransmission's TSval still gives a sample
+            client.write("hello");
+            const auto first_ts = timestamps_of(client.segments_out().front());
+            // TSval follows the millisecond clock, and data echoes the peer's latest TSval
+            test_should_be(first_ts.value, syn_ts.value + 10);
+            test_should_be(first_ts.echo_reply, syn_ack_ts.value);
+            client.segments_out().pop();
+            client.tick(client.retransmission_timeout());
+            test_should_be(client.segments_out().size(), size_t{1});
+            const auto retx_ts = timestamps_of(client.segments_out().front());
+            client.tick(30);
+            deliver(client, server);
+            // the ACK echoes the retransmission's TSval
+            test_should_be(timestamps_of(server.segments_out().front()).echo_reply, retx_ts.value);
+            deliver(server, client);
+            // the ACK of a retransmission gives a 30 ms sample
+            test_should_be(client.srtt(), optional<double>{0.875 * 10 + 0.125 * 30});
+            test_should_be(client.bytes_in_flight(), size_t{0});
+
+            // PAWS: a segment whose TSval is older than the last one seen is an old duplicate and is dropped,
+            // along with its ACK; the server answers with an ACK of its own
+            client.tick(5);
+            client.write(" world");
+            TCPSegment stale = client.segments_out().front();
+            client.segments_out().pop();
+            stale.header().options.timestamps->value = retx_ts.value - 1;
+            server.segment_received(stale);
+            test_err_if(server.inbound_stream().buffer_size() != 5, "a segment with an old timestamp is dropped");
+            test_err_if(server.segments_out().size() != 1 or server.segments_out().front().payload().size() != 0,
+                        "the dropped segment is answered with an ACK");
+            server.segments_out().pop();
+            // the same segment with a fresh timestamp is accepted
+            stale.header().options.timestamps->value = retx_ts.value + 5;
+            server.segment_received(stale);
+            test_err_if(server.inbound_stream().buffer_size() != 11, "a segment with a newer timestamp is accepted");
+        }
+
+        {
+            // an echo from the future is bogus: no sample is taken from it, and the ACK falls back to timing
+            // the segment itself
+            TCPConnection client{cfg}, server{cfg};
+            client.connect();
+            deliver(client, server);
+            client.tick(10);
+            deliver(server, client);
+            deliver(client, server);
+            client.write("hello");
+            const auto data_ts = timestamps_of(client.segments_out().front());
+            deliver(client, server);
+            client.tick(20);
+            TCPSegment ack = server.segments_out().front();
+            server.segments_out().pop();
+            ack.header().options.timestamps->echo_reply = data_ts.value + 100000;
+            client.segment_received(ack);
+            test_should_be(client.bytes_in_flight(), size_t{0});
+            test_should_be(client.srtt(), optional<double>{0.875 * 10 + 0.125 * 20});
+        }
+
+        {
+            // with delayed ACKs, one ACK for two segments echoes the first one's TSval (TS.Recent only moves for
+            // a segment that starts at or before the last ackno sent), so the sample counts the time it was held
+            TCPConfig delaying = cfg;
+            delaying.delayed_ack = true;
+            TCPConnection client{cfg}, server{delaying};
+            handshake(client, server);
+            client.write("hello");
+            const auto first_ts = timestamps_of(client.segments_out().front());
+            deliver(client, server);
+            test_err_if(not server.segments_out().empty(), "the first segment's ACK is held");
+            client.tick(30);
+            server.tick(30);
+            client.write(" world");
+            deliver(client, server);
+            test_should_be(server.segments_out().size(), size_t{1});
+            test_should_be(timestamps_of(server.segments_out().front()).echo_reply, first_ts.value);
+            deliver(server, client);
+            // the handshake gave a 0 ms sample
+            test_should_be(client.srtt(), optional<double>{0.125 * 30});
+        }
+
+        {
+            // a peer that does not agree: neither side sends timestamps after the SYN
+            TCPConfig plain;
+            TCPConnection client{cfg}, server{plain};
+            client.connect();
+            test_err_if(not client.segments_out().front().header().options.timestamps.has_value(),
+                        "the SYN offers them");
+            deliver(client, server);
+            test_err_if(server.segments_out().front().header().options.timestamps.has_value(),
+                        "the SYN-ACK declines");
+            deliver(server, client);
+            deliver(client, server);
+            client.write("hello");
+            test_err_if(client.segments_out().front().header().options.timestamps.has_value(),
+                        "data carries no timestamps");
+            deliver(client, server);
+            test_should_be(server.inbound_stream().buffer_size(), size_t{5});
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
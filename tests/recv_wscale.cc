@@ -0,0 +1,82 @@
+#include "tcp_connection.hh"
+#include "tcp_header.hh"
+#include "tcp_pair_harness.hh"
+#include "test_should_be.hh"
+#include "util.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main() {
+    try {
+        constexpr size_t big = 4 * 1024 * 1024;
+        TCPConfig cfg;
+        cfg.recv_capacity = big;
+        cfg.send_capacity = big;
+
+        {
+            TCPConnection client{cfg}, server{cfg};
+            client.connect();
+            const TCPHeader &syn = client.segments_out().front().header();
+            // 4 MiB >> 6 is still 65536, so the smallest shift that fits is 7
+            test_should_be(syn.options.window_scale, optional<uint8_t>{7});
+            deliver(client, server);
+            const TCPHeader &syn_ack = server.segments_out().front().header();
+            test_should_be(syn_ack.options.window_scale, optional<uint8_t>{7});
+            // the window on a SYN is never scaled
+            test_should_be(syn_ack.win, uint16_t{UINT16_MAX});
+            deliver(server, client);
+            deliver(client, server);
+
+            // the SYN-ACK's unscaled window limits the first flight; the scaled acks for it then open
+            // the window far past 64 KiB, so the rest of the megabyte goes out in one flight
+            constexpr size_t total = 1024 * 1024;
+            client.write(string(total, 'x'));
+            const size_t first_flight = client.bytes_in_flight();
+            test_err_if(first_flight == 0 or first_flight > UINT16_MAX,
+                        "the first flight should fit the SYN-ACK window");
+            deliver(client, server);
+            // the ack advertises the remaining window scaled down by 7
+            test_should_be(server.segments_out().back().header().win, uint16_t((big - first_flight) >> 7));
+            deliver(server, client);
+            test_should_be(client.bytes_in_flight(), total - first_flight);
+            deliver(client, server);
+            test_should_be(server.inbound_stream().buffer_size(), total);
+        }
+
+        {
+            // a peer that does not offer the option: no scaling in either direction
+            TCPConnection server{cfg};
+            TCPSegment syn;
+            syn.header().syn = true;
+            syn.header().seqno = WrappingInt32{1000};
+            syn.header().win = 5000;
+            server.segment_received(syn);
+            const TCPHeader &syn_ack = server.segments_out().front().header();
+            test_err_if(syn_ack.options.window_scale.has_value(), "the option should not be sent unless offered");
+            // a large window is capped, not truncated
+            test_should_be(syn_ack.win, uint16_t{UINT16_MAX});
+
+            TCPSegment ack;
+            ack.header().ack = true;
+            ack.header().seqno = WrappingInt32{1001};
+            ack.header().ackno = syn_ack.seqno + 1;
+            ack.header().win = 5000;
+            server.segments_out().pop();
+            server.segment_received(ack);
+            server.write(string(20000, 'x'));
+            // the peer's window is not scaled
+            test_should_be(server.bytes_in_flight(), size_t{5000});
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,145 @@
+#include "tcp_config.hh"
+#include "tcp_sender.hh"
+#include "test_err_if.hh"
+#include "test_should_be.hh"
+#include "util.hh"
+#include "wrapping_integers.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <iostream>
+#include <set>
+#include <string>
+
+using namespace std;
+
+static constexpr size_t MSS = TCPConfig::MAX_PAYLOAD_SIZE;
+static constexpr uint16_t WIN = 65000;
+static constexpr double BANDWIDTH = MSS;  // bottleneck rate: one segment per millisecond
+static constexpr uint64_t RTPROP = 20;    // propagation round-trip time, so the BDP is 20 segments
+
+// a sender behind a bottleneck link with an unbounded FIFO queue, simulated one millisecond at a time
+class Bottleneck {
+    TCPSender _sender;
+    struct Ack {
+        uint64_t at;
+        WrappingInt32 ackno;
+    };
+    deque<Ack> _acks{};
+    uint64_t _now = 0;
+    double _link_free = 0;
+
+  public:
+    // measured over the current interval, see `reset_stats`
+    size_t segments = 0;
+    size_t acked_bytes = 0;
+    double queueing_delay = 0;
+
+    explicit Bottleneck(const CongestionControlAlgorithm algorithm, const WrappingInt32 isn)
+        : _sender([&] {
+            TCPConfig cfg;
+            cfg.fixed_isn = isn;
+            cfg.send_capacity = 1 << 20;
+            cfg.congestion_control = algorithm;
+            return cfg;
+        }()) {
+        _sender.fill_window();
+        _sender.segments_out().pop();
+        _acks.push_back({RTPROP, isn + 1});
+    }
+
+    void step() {
+        ++_now;
+        _sender.tick(1);
+        while (not _acks.empty() and _acks.front().at <= _now) {
+            const size_t before = _sender.bytes_in_flight();
+            _sender.ack_received(_acks.front().ackno, WIN);
+            acked_bytes += before - _sender.bytes_in_flight();
+            _acks.pop_front();
+        }
+        const string data(_sender.stream_in().remaining_capacity(), 'x');
+        _sender.stream_in().write(data);
+        _sender.fill_window();
+
+        while (not _sender.segments_out().empty()) {
+            const TCPSegment &seg = _sender.segments_out().front();
+            const double start = max(double(_now), _link_free);
+            _link_free = start + seg.length_in_sequence_space() / BANDWIDTH;
+            queueing_delay += start - _now;
+            ++segments;
+            _acks.push_back({uint64_t(ceil(_link_free)) + RTPROP, seg.header().seqno + seg.length_in_sequence_space()});
+            _sender.segments_out().pop();
+        }
+    }
+
+    void reset_stats() {
+        segments = 0;
+        acked_bytes = 0;
+        queueing_delay = 0;
+    }
+
+    uint64_t now() const { return _now; }
+    const TCPSender &sender() const { return _sender; }
+    const BBR &bbr() const { return dynamic_cast<const BBR &>(*_sender.congestion_control()); }
+};
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        Bottleneck bbr{CongestionControlAlgorithm::BBR, WrappingInt32(rd())};
+        Bottleneck reno{CongestionControlAlgorithm::NewReno, WrappingInt32(rd())};
+
+        // startup finds the bottleneck, then drain empties the queue it built
+        set<BBR::Mode> modes;
+        while (bbr.now() < 2000) {
+            bbr.step();
+            reno.step();
+            modes.insert(bbr.bbr().mode());
+        }
+        test_err_if(not modes.count(BBR::Mode::Startup) or not modes.count(BBR::Mode::Drain),
+                    "BBR should pass through drain");
+        test_err_if(bbr.bbr().mode() != BBR::Mode::ProbeBW, "BBR should settle in ProbeBW");
+        test_err_if(abs(bbr.bbr().bottleneck_bandwidth() - BANDWIDTH) >= BANDWIDTH / 10, "wrong bottleneck bandwidth");
+        test_err_if(bbr.bbr().min_rtt().value_or(0) < RTPROP or bbr.bbr().min_rtt().value_or(0) > RTPROP + 2,
+                    "wrong round-trip propagation time");
+        test_err_if(bbr.sender().bytes_in_flight() > 2 * RTPROP * MSS + 3 * MSS, "cwnd should be capped at 2 BDP");
+
+        // steady state: the link stays busy while the queue stays short; NewReno fills the receive window
+        bbr.reset_stats();
+        reno.reset_stats();
+        while (bbr.now() < 8000) {
+            bbr.step();
+            reno.step();
+        }
+        test_err_if(bbr.acked_bytes < 6000 * BANDWIDTH * 0.9, "BBR should keep the bottleneck busy");
+        const double bbr_delay = bbr.queueing_delay / bbr.segments;
+        const double reno_delay = reno.queueing_delay / reno.segments;
+        test_err_if(bbr_delay >= 5, "BBR should keep the queueing delay low, got " + to_string(bbr_delay) + " ms");
+        test_err_if(reno_delay <= 15, "NewReno should fill the queue, got " + to_string(reno_delay) + " ms");
+        // no loss means no retransmission
+        test_should_be(bbr.sender().consecutive_retransmissions(), 0u);
+
+        // RTprop is re-measured after 10 s: the window drops to 4 segments, then returns to ProbeBW
+        bool probed_rtt = false;
+        while (bbr.now() < 13000) {
+            bbr.step();
+            if (bbr.bbr().mode() == BBR::Mode::ProbeRTT) {
+                probed_rtt = true;
+                // ProbeRTT shrinks cwnd to 4 segments
+                test_should_be(bbr.sender().congestion_window(), 4 * MSS);
+            }
+        }
+        test_err_if(not probed_rtt, "BBR should enter ProbeRTT when RTprop is 10 s old");
+        test_err_if(bbr.bbr().mode() != BBR::Mode::ProbeBW, "BBR should go back to ProbeBW after ProbeRTT");
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
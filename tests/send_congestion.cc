@@ -0,0 +1,138 @@
+#include "sender_harness.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+        const size_t MSS = TCPConfig::MAX_PAYLOAD_SIZE;
+        const uint16_t WIN = 65000;
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.congestion_control = CongestionControlAlgorithm::NewReno;
+
+            TCPSenderTestHarness test{"NewReno initial window and slow start", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(WIN));
+            test.execute(WriteBytes{string(20 * MSS, 'x')});
+            // the harness hands back the most recently sent segment first
+            for (size_t i = 10; i-- > 0;) {
+                test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 1 + i * MSS));
+            }
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectCongestionWindow(10 * MSS));
+
+            // each acked segment opens the window by one more MSS
+            test.execute(AckReceived{WrappingInt32{isn + 1 + uint32_t(MSS)}}.with_win(WIN));
+            test.execute(ExpectCongestionWindow(11 * MSS));
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 1 + 11 * MSS));
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 1 + 10 * MSS));
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectBytesInFlight(11 * MSS));
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.congestion_control = CongestionControlAlgorithm::NewReno;
+
+            TCPSenderTestHarness test{"NewReno fast retransmit and fast recovery", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(WIN));
+            test.execute(WriteBytes{string(20 * MSS, 'x')});
+            for (size_t i = 0; i < 10; ++i) {
+                test.execute(ExpectSegment{}.with_payload_size(MSS));
+            }
+
+            // the third duplicate retransmits the first segment and halves the window
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(WIN));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(WIN));
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(WIN));
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 1));
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectCongestionWindow(8 * MSS));
+
+            // further duplicates inflate the window until new data can go out
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(WIN));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(WIN));
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(WIN));
+            test.execute(ExpectCongestionWindow(11 * MSS));
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 1 + 10 * MSS));
+            test.execute(ExpectNoSegment{});
+
+            // a partial ack retransmits the next hole right away
+            test.execute(AckReceived{WrappingInt32{isn + 1 + 2 * uint32_t(MSS)}}.with_win(WIN));
+            test.execute(ExpectCongestionWindow(10 * MSS));
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 1 + 11 * MSS));
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 1 + 2 * MSS));
+            test.execute(ExpectNoSegment{});
+
+            // acking everything sent before the loss ends recovery with cwnd = ssthresh
+            test.execute(AckReceived{WrappingInt32{isn + 1 + 10 * uint32_t(MSS)}}.with_win(WIN));
+            test.execute(ExpectCongestionWindow(5 * MSS));
+            for (size_t i = 15; i-- > 12;) {
+                test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 1 + i * MSS));
+            }
+            test.execute(ExpectNoSegment{});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.congestion_control = CongestionControlAlgorithm::NewReno;
+
+            TCPSenderTestHarness test{"NewReno restarts from one segment after a timeout", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(WIN));
+            test.execute(WriteBytes{string(20 * MSS, 'x')});
+            for (size_t i = 0; i < 10; ++i) {
+                test.execute(ExpectSegment{}.with_payload_size(MSS));
+            }
+            test.execute(Tick{cfg.rt_timeout});
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 1));
+            test.execute(ExpectCongestionWindow(MSS));
+
+            // the retransmission is acked: slow start grows the window again
+            test.execute(AckReceived{WrappingInt32{isn + 1 + uint32_t(MSS)}}.with_win(WIN));
+            test.execute(ExpectCongestionWindow(2 * MSS));
+            test.execute(ExpectNoSegment{});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+
+            TCPSenderTestHarness test{"Without congestion control only the receiver's window limits", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(WIN));
+            test.execute(WriteBytes{string(20 * MSS, 'x')});
+            for (size_t i = 0; i < 20; ++i) {
+                test.execute(ExpectSegment{}.with_payload_size(MSS));
+            }
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(WIN));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(WIN));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(WIN));
+            test.execute(ExpectNoSegment{});
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,144 @@
+#include "tcp_config.hh"
+#include "tcp_sender.hh"
+#include "test_err_if.hh"
+#include "test_should_be.hh"
+#include "util.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static constexpr size_t MSS = TCPConfig::MAX_PAYLOAD_SIZE;
+static constexpr uint16_t WIN = 65000;
+static constexpr size_t RTT = 1000;
+
+// a path that delivers every segment and returns its ack one RTT later, unless asked to drop one
+class Path {
+    TCPSender _sender;
+
+  public:
+    explicit Path(const CongestionControlAlgorithm algorithm, const WrappingInt32 isn)
+        : _sender([&] {
+            TCPConfig cfg;
+            cfg.fixed_isn = isn;
+            cfg.send_capacity = 1 << 20;
+            cfg.rt_timeout = 10 * RTT;
+            cfg.congestion_control = algorithm;
+            return cfg;
+        }()) {
+        _sender.fill_window();
+        _sender.segments_out().pop();
+        _sender.tick(RTT);
+        _sender.ack_received(isn + 1, WIN);
+    }
+
+    // one round trip: send what the window allows, then ack every segment in order;
+    // with `drop_first` the first segment is lost, repaired by fast retransmit, and then acked
+    void round(const bool drop_first = false) {
+        const string data(_sender.stream_in().remaining_capacity(), 'x');
+        _sender.stream_in().write(data);
+        _sender.fill_window();
+        vector<TCPSegment> segments;
+        while (not _sender.segments_out().empty()) {
+            segments.push_back(_sender.segments_out().front());
+            _sender.segments_out().pop();
+        }
+        _sender.tick(RTT);
+        if (drop_first) {
+            if (segments.size() < 4) {
+                throw runtime_error("too few segments in flight to trigger fast retransmit");
+            }
+            for (size_t i = 1; i < segments.size(); ++i) {
+                _sender.ack_received(segments.front().header().seqno, WIN);
+            }
+            if (not _sender.in_fast_recovery() or _sender.segments_out().empty() or
+                _sender.segments_out().front().header().seqno != segments.front().header().seqno) {
+                throw runtime_error("duplicate acks did not start fast recovery");
+            }
+            // the retransmission gets through; new data sent during recovery goes out with the next round
+            _sender.segments_out().pop();
+            const auto &last = segments.back();
+            _sender.ack_received(last.header().seqno + last.length_in_sequence_space(), WIN);
+            if (_sender.in_fast_recovery()) {
+                throw runtime_error("acking the whole window did not end fast recovery");
+            }
+            return;
+        }
+        for (const auto &seg : segments) {
+            _sender.ack_received(seg.header().seqno + seg.length_in_sequence_space(), WIN);
+        }
+    }
+
+    size_t cwnd() const { return _sender.congestion_window(); }
+};
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        // slow start from the 10-segment initial window to 40 segments, then lose one segment
+        Path cubic{CongestionControlAlgorithm::Cubic, WrappingInt32(rd())};
+        Path reno{CongestionControlAlgorithm::NewReno, WrappingInt32(rd())};
+        for (Path *path : {&cubic, &reno}) {
+            path->round();
+            path->round();
+            // slow start doubles the window each round
+            test_should_be(path->cwnd(), 40 * MSS);
+            path->round(true);
+        }
+        // CUBIC reduces the window by beta = 0.7, NewReno halves it
+        test_should_be(cubic.cwnd(), 28 * MSS);
+        test_should_be(reno.cwnd(), 20 * MSS);
+
+        // concave growth: fast at first, flattening out as the window nears W_max = 40 segments
+        // (K = cbrt(40 * 0.3 / 0.4) ~ 3.1 s)
+        vector<size_t> windows{cubic.cwnd()};
+        for (size_t i = 0; i < 4; ++i) {
+            cubic.round();
+            reno.round();
+            windows.push_back(cubic.cwnd());
+        }
+        test_err_if(windows[1] - windows[0] <= windows[3] - windows[2], "CUBIC growth should slow down near W_max");
+        test_err_if(windows[3] <= 38 * MSS or windows[3] > 41 * MSS, "CUBIC should plateau around W_max after K");
+        test_err_if(reno.cwnd() >= 25 * MSS, "NewReno grows by about one segment per round trip");
+        test_err_if(cubic.cwnd() <= reno.cwnd() + 10 * MSS, "CUBIC should recover much faster than NewReno");
+
+        // convex growth: past K the window probes beyond W_max faster and faster
+        for (size_t i = 0; i < 2; ++i) {
+            cubic.round();
+            windows.push_back(cubic.cwnd());
+        }
+        test_err_if(windows[6] - windows[5] <= windows[5] - windows[4], "CUBIC growth should accelerate past W_max");
+        test_err_if(windows[6] <= 40 * MSS, "CUBIC should probe beyond W_max");
+
+        // fast convergence: a second loss below the previous W_max releases extra bandwidth
+        {
+            Path path{CongestionControlAlgorithm::Cubic, WrappingInt32(rd())};
+            path.round();
+            path.round();
+            path.round(true);
+            const size_t before = path.cwnd();
+            path.round(true);
+            // a second loss reduces the window by beta again
+            test_should_be(path.cwnd(), size_t(before * 0.7));
+            // the next epoch now aims at (1 + beta) / 2 of the window at the second loss
+            path.round();
+            path.round();
+            path.round();
+            path.round();
+            test_err_if(path.cwnd() >= before, "fast convergence should lower the plateau below the previous window");
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,83 @@
+#include "sender_harness.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+        const size_t MSS = TCPConfig::MAX_PAYLOAD_SIZE;
+        const uint16_t WIN = 65000;
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.fast_retransmit = true;
+
+            TCPSenderTestHarness test{"Fast retransmit without congestion control", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(WIN));
+            test.execute(WriteBytes{string(5 * MSS, 'x')});
+            for (size_t i = 0; i < 5; ++i) {
+                test.execute(ExpectSegment{}.with_payload_size(MSS));
+            }
+
+            // two duplicates are not enough, the third retransmits the first outstanding segment at once
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(WIN));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(WIN));
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(WIN));
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 1));
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectBytesInFlight(5 * MSS));
+            test.execute(ExpectFastRecovery{true});
+
+            // more duplicates during recovery retransmit nothing new; new data still goes out
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(WIN));
+            test.execute(ExpectNoSegment{});
+            test.execute(WriteBytes{string(MSS, 'y')});
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 1 + 5 * MSS));
+
+            // a partial ack retransmits the next hole right away (NewReno)
+            test.execute(AckReceived{WrappingInt32{isn + 1 + 2 * uint32_t(MSS)}}.with_win(WIN));
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 1 + 2 * MSS));
+            test.execute(ExpectNoSegment{});
+
+            // acking everything sent before the loss ends recovery
+            test.execute(AckReceived{WrappingInt32{isn + 1 + 5 * uint32_t(MSS)}}.with_win(WIN));
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectBytesInFlight(MSS));
+            test.execute(ExpectFastRecovery{false});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+
+            TCPSenderTestHarness test{"Duplicate acks are ignored unless fast retransmit is on", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(WIN));
+            test.execute(WriteBytes{string(5 * MSS, 'x')});
+            for (size_t i = 0; i < 5; ++i) {
+                test.execute(ExpectSegment{}.with_payload_size(MSS));
+            }
+            for (size_t i = 0; i < 5; ++i) {
+                test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(WIN));
+            }
+            test.execute(ExpectNoSegment{});
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,117 @@
+#include "tcp_connection.hh"
+#include "tcp_header.hh"
+#include "tcp_pair_harness.hh"
+#include "test_should_be.hh"
+#include "util.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <string>
+
+using namespace std;
+
+// write `rounds` chunks through a path limited to `path_mss`, running the retransmission timer whenever data
+// stays unacknowledged, until the server has every byte including `pending` ones written earlier; returns
+// the largest payload seen
+static size_t transfer(TCPConnection &client,
+                       TCPConnection &server,
+                       const size_t rounds,
+                       const size_t path_mss,
+                       const size_t pending = 0) {
+    size_t largest = 0;
+    size_t goal = server.inbound_stream().bytes_written() + pending;
+    for (size_t i = 0; i < rounds or server.inbound_stream().bytes_written() < goal; ++i) {
+        test_err_if(i >= 10 * rounds, "the transfer should make progress");
+        if (i < rounds) {
+            goal += client.write(string(40000, 'x'));
+        }
+        largest = max(largest, deliver(client, server, drop_larger_than(path_mss)).largest_payload);
+        deliver(server, client);
+        if (client.bytes_in_flight() > 0) {
+            client.tick(client.time_until_next_timer().value());
+        }
+        server.inbound_stream().pop_output(server.inbound_stream().buffer_size());
+    }
+    test_should_be(server.inbound_stream().bytes_written(), goal);
+    return largest;
+}
+
+int main() {
+    try {
+        {
+            // each end advertises its own MSS; segments are no larger than the smaller one
+            TCPConfig client_cfg, server_cfg;
+            client_cfg.mss = 1400;
+            server_cfg.mss = 536;
+            TCPConnection client{client_cfg}, server{server_cfg};
+            client.connect();
+            test_should_be(client.segments_out().front().header().options.mss, optional<uint16_t>{1400});
+            deliver(client, server);
+            test_should_be(server.segments_out().front().header().options.mss, optional<uint16_t>{536});
+            deliver(server, client);
+            deliver(client, server);
+            // both ends use the smaller MSS
+            test_should_be(client.mss(), size_t{536});
+            test_should_be(server.mss(), size_t{536});
+
+            client.write(string(5000, 'x'));
+            // data goes out in segments of the peer's MSS, in both directions
+            test_should_be(deliver(client, server).largest_payload, size_t{536});
+            server.write(string(5000, 'y'));
+            test_should_be(deliver(server, client).largest_payload, size_t{536});
+            test_should_be(server.inbound_stream().buffer_size(), size_t{5000});
+            test_should_be(client.inbound_stream().buffer_size(), size_t{5000});
+        }
+
+        TCPConfig cfg;
+        cfg.mss = 8952;
+        cfg.mtu_probing = true;
+        cfg.recv_capacity = 1024 * 1024;
+        cfg.send_capacity = 1024 * 1024;
+
+        {
+            // probing starts at the base size and climbs to the MSS over a path that carries anything
+            TCPConnection client{cfg}, server{cfg};
+            handshake(client, server);
+            // probing starts from the base size
+            test_should_be(client.mss(), size_t{1024});
+            test_should_be(client.max_mss(), size_t{8952});
+            const size_t largest = transfer(client, server, 20, SIZE_MAX);
+            test_err_if(largest <= 8952 - 8 or client.mss() <= 8952 - 8, "the search should end near the MSS");
+        }
+
+        {
+            // probes that do not fit the path are lost; the search settles just under the path's limit
+            TCPConnection client{cfg}, server{cfg};
+            handshake(client, server);
+            transfer(client, server, 30, 3000);
+            test_err_if(client.mss() > 3000 or client.mss() <= 3000 - 8, "the search should end near the path limit");
+        }
+
+        {
+            // after the search, the path shrinks: full-sized segments vanish, and after two timeouts the
+            // sender falls back to the base size so that the retransmissions get through
+            TCPConnection client{cfg}, server{cfg};
+            handshake(client, server);
+            transfer(client, server, 20, SIZE_MAX);
+            test_err_if(client.mss() <= 8000, "the search should have found a large MSS");
+            const size_t written = client.write(string(40000, 'x'));
+            deliver(client, server, drop_larger_than(1500));
+            client.tick(client.time_until_next_timer().value());
+            deliver(client, server, drop_larger_than(1500));
+            client.tick(client.time_until_next_timer().value());
+            // two timeouts of full-sized segments fall back to the base size
+            test_should_be(client.mss(), size_t{1024});
+            transfer(client, server, 10, 1500, written);
+            test_err_if(client.mss() > 1500, "the search should stay under the new path limit");
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,126 @@
+#include "sender_harness.hh"
+#include "tcp_connection.hh"
+#include "tcp_pair_harness.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// the payload sizes of the segments `conn` has queued, which are then dropped
+static vector<size_t> take_payload_sizes(TCPConnection &conn) {
+    vector<size_t> sizes{};
+    for (; not conn.segments_out().empty(); conn.segments_out().pop()) {
+        sizes.push_back(conn.segments_out().front().payload().size());
+    }
+    return sizes;
+}
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+        const size_t MSS = TCPConfig::MAX_PAYLOAD_SIZE;
+        const uint16_t WIN = 65000;
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.nagle = true;
+
+            TCPSenderTestHarness test{"Nagle holds short segments while data is unacknowledged", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(WIN));
+            // nothing in flight: the first small write goes out at once
+            test.execute(WriteBytes{"a"});
+            test.execute(ExpectSegment{}.with_data("a"));
+            test.execute(WriteBytes{"b"});
+            test.execute(WriteBytes{"c"});
+            test.execute(ExpectNoSegment{});
+            // the ack releases the coalesced bytes
+            test.execute(AckReceived{WrappingInt32{isn + 2}}.with_win(WIN));
+            test.execute(ExpectSegment{}.with_data("bc").with_seqno(isn + 2));
+            test.execute(ExpectNoSegment{});
+
+            // full segments are never held, only the short tail
+            test.execute(WriteBytes{string(MSS + 10, 'x')});
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 4));
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{WrappingInt32{isn + 4 + uint32_t(MSS)}}.with_win(WIN));
+            test.execute(ExpectSegment{}.with_payload_size(10));
+            test.execute(ExpectNoSegment{});
+
+            // a short segment that carries the FIN is not held
+            test.execute(WriteBytes{"d"});
+            test.execute(ExpectNoSegment{});
+            test.execute(Close{});
+            test.execute(ExpectSegment{}.with_data("d").with_fin(true));
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.autocork = true;
+
+            TCPSenderTestHarness test{"Autocork holds short segments only behind another short segment", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(WIN));
+            test.execute(WriteBytes{"a"});
+            test.execute(ExpectSegment{}.with_data("a"));
+            test.execute(WriteBytes{"b"});
+            test.execute(ExpectNoSegment{});
+            test.execute(WriteBytes{string(MSS, 'x')});
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 2));
+            test.execute(ExpectNoSegment{});
+            // acking the short segment releases the held byte even though the full one is still in flight
+            test.execute(AckReceived{WrappingInt32{isn + 2}}.with_win(WIN));
+            test.execute(ExpectSegment{}.with_payload_size(1).with_seqno(isn + 2 + MSS));
+            test.execute(AckReceived{WrappingInt32{isn + 3 + uint32_t(MSS)}}.with_win(WIN));
+
+            // behind full-sized segments, the tail of a bulk write goes out without waiting
+            test.execute(WriteBytes{string(2 * MSS + 5, 'y')});
+            test.execute(ExpectSegment{}.with_payload_size(5));
+            test.execute(ExpectSegment{}.with_payload_size(MSS));
+            test.execute(ExpectSegment{}.with_payload_size(MSS));
+            test.execute(ExpectNoSegment{});
+        }
+
+        {
+            TCPConfig cfg;
+            TCPConnection client{cfg}, server{cfg};
+            handshake(client, server);
+
+            // corked: only full segments go out, the rest waits at most 200 ms
+            client.set_corked(true);
+            client.write("abc");
+            test_err_if(not take_payload_sizes(client).empty(), "corked data should be held");
+            client.write(string(MSS, 'x'));
+            test_err_if((take_payload_sizes(client) != vector<size_t>{MSS}),
+                        "a full segment should go out while corked");
+            client.tick(199);
+            test_err_if(not take_payload_sizes(client).empty(), "corked data should wait up to 200 ms");
+            client.tick(1);
+            test_err_if((take_payload_sizes(client) != vector<size_t>{3}), "corked data should go out after 200 ms");
+
+            // uncorking sends the held data at once
+            client.write("yz");
+            test_err_if(not take_payload_sizes(client).empty(), "corked data should be held");
+            client.set_corked(false);
+            test_err_if((take_payload_sizes(client) != vector<size_t>{2}), "uncorking should send the held data");
+            client.write("w");
+            test_err_if((take_payload_sizes(client) != vector<size_t>{1}), "without cork small writes go out at once");
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,126 @@
+#include "sender_harness.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <string>
+
+using namespace std;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+        const size_t MSS = TCPConfig::MAX_PAYLOAD_SIZE;
+        const uint16_t WIN = 65000;
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.pacing = true;
+            cfg.pacing_rate = 1000 * MSS;
+
+            TCPSenderTestHarness test{"A configured pacing rate releases segments as time passes", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(ExpectPacingRate{double(MSS)});
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(WIN));
+            test.execute(WriteBytes{string(10 * MSS, 'x')});
+            test.execute(ExpectNoSegment{});
+
+            // one segment per millisecond
+            test.execute(Tick{1});
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 1));
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{1});
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 1 + MSS));
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{3});
+            for (size_t i = 0; i < 3; ++i) {
+                test.execute(ExpectSegment{}.with_payload_size(MSS));
+            }
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{5});
+            for (size_t i = 0; i < 5; ++i) {
+                test.execute(ExpectSegment{}.with_payload_size(MSS));
+            }
+            test.execute(AckReceived{WrappingInt32{isn + 1 + 10 * uint32_t(MSS)}}.with_win(WIN));
+
+            // after a long idle period only a short burst goes out at once
+            test.execute(Tick{1000});
+            test.execute(WriteBytes{string(20 * MSS, 'y')});
+            for (size_t i = 0; i < 10; ++i) {
+                test.execute(ExpectSegment{}.with_payload_size(MSS));
+            }
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{1});
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 1 + 20 * MSS));
+            test.execute(ExpectNoSegment{});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.pacing = true;
+            cfg.congestion_control = CongestionControlAlgorithm::NewReno;
+
+            TCPSenderTestHarness test{"Pacing derived from cwnd / SRTT", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            // no RTT sample yet: the initial window goes out unpaced
+            test.execute(ExpectPacingRate{nullopt});
+            test.execute(Tick{100});
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(WIN));
+            // slow start paces at twice the window per SRTT
+            test.execute(ExpectPacingRate{2.0 * (10 * MSS) / 100});
+            test.execute(WriteBytes{string(10 * MSS, 'x')});
+            test.execute(ExpectNoSegment{});
+            // a segment goes out as soon as there is any budget, and the debt holds the next one back
+            test.execute(Tick{1});
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 1));
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{3});
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{3});
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(isn + 1 + MSS));
+            test.execute(ExpectNoSegment{});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.pacing = true;
+
+            TCPSenderTestHarness test{"Without congestion control, pacing follows the receiver's window", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(Tick{100});
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(1000));
+            test.execute(ExpectPacingRate{1.2 * 1000 / 100});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.congestion_control = CongestionControlAlgorithm::NewReno;
+
+            TCPSenderTestHarness test{"No pacing unless asked for", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(Tick{100});
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(WIN));
+            test.execute(ExpectPacingRate{nullopt});
+            test.execute(WriteBytes{string(3 * MSS, 'x')});
+            for (size_t i = 0; i < 3; ++i) {
+                test.execute(ExpectSegment{}.with_payload_size(MSS));
+            }
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -105,6 +105,23 @@ int main() {
             test.execute(Tick{1}.with_max_retx_exceeded(true));
         }
 
+        {
+            WrappingInt32 isn(rd());
+            TCPConfig cfg;
+            cfg.fixed_isn = isn;
+            cfg.rt_timeout = TCPConfig::TIMEOUT_DFLT;
+
+            TCPSenderTestHarness test{"Retx after an ack in the middle of a segment resends only the rest", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}});
+            test.execute(WriteBytes{"abcdefgh"});
+            test.execute(ExpectSegment{}.with_data("abcdefgh"));
+            test.execute(AckReceived{WrappingInt32{isn + 4}});
+            test.execute(Tick{TCPConfig::TIMEOUT_DFLT});
+            test.execute(ExpectSegment{}.with_data("defgh").with_seqno(isn + 4));
+            test.execute(ExpectNoSegment{});
+        }
+
     } catch (const exception &e) {
         cerr << e.what() << endl;
         return 1;
@@ -0,0 +1,129 @@
+#include "sender_harness.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.adaptive_rto = true;
+
+            TCPSenderTestHarness test{"RFC 6298 RTT estimate and RTO", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(ExpectRetransmissionTimeout{TCPConfig::TIMEOUT_DFLT});
+
+            // the first sample sets SRTT = R and RTTVAR = R / 2, so RTO = 100 + 4 * 50
+            test.execute(Tick{100});
+            test.execute(AckReceived{WrappingInt32{isn + 1}});
+            test.execute(ExpectRTTEstimate{100, 50});
+            test.execute(ExpectRetransmissionTimeout{300});
+
+            // later samples move RTTVAR by 1/4 and SRTT by 1/8 of the difference
+            test.execute(WriteBytes{"abc"});
+            test.execute(ExpectSegment{}.with_data("abc"));
+            test.execute(Tick{50});
+            test.execute(AckReceived{WrappingInt32{isn + 4}});
+            test.execute(ExpectRTTEstimate{93.75, 50});
+            test.execute(ExpectRetransmissionTimeout{294});
+
+            // the timer uses the new RTO, and doubles it on expiry
+            test.execute(WriteBytes{"def"});
+            test.execute(ExpectSegment{}.with_data("def"));
+            test.execute(Tick{293});
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{1});
+            test.execute(ExpectSegment{}.with_data("def"));
+            test.execute(ExpectRetransmissionTimeout{588});
+
+            // Karn: an ack for a retransmitted segment gives no sample, but the backoff is cleared
+            test.execute(Tick{10});
+            test.execute(AckReceived{WrappingInt32{isn + 7}});
+            test.execute(ExpectRTTEstimate{93.75, 50});
+            test.execute(ExpectRetransmissionTimeout{294});
+
+            // a cumulative ack is timed from the oldest segment it covers
+            test.execute(WriteBytes{"g"});
+            test.execute(Tick{60});
+            test.execute(WriteBytes{"h"});
+            test.execute(Tick{40});
+            test.execute(AckReceived{WrappingInt32{isn + 9}});
+            test.execute(ExpectRTTEstimate{94.53125, 39.0625});
+            test.execute(ExpectRetransmissionTimeout{251});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.adaptive_rto = true;
+            cfg.rto_min = 10;
+
+            TCPSenderTestHarness test{"RTO floor on a fast path", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(Tick{2});
+            test.execute(AckReceived{WrappingInt32{isn + 1}});
+            test.execute(ExpectRTTEstimate{2, 1});
+            test.execute(ExpectRetransmissionTimeout{10});
+            test.execute(WriteBytes{"abc"});
+            test.execute(ExpectSegment{}.with_data("abc"));
+            test.execute(Tick{9});
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{1});
+            test.execute(ExpectSegment{}.with_data("abc"));
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.adaptive_rto = true;
+            cfg.rto_max = 1000;
+
+            TCPSenderTestHarness test{"RTO ceiling caps the backoff", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(Tick{100});
+            test.execute(AckReceived{WrappingInt32{isn + 1}});
+            test.execute(WriteBytes{"abc"});
+            test.execute(ExpectSegment{}.with_data("abc"));
+            test.execute(Tick{300});
+            test.execute(ExpectSegment{}.with_data("abc"));
+            test.execute(ExpectRetransmissionTimeout{600});
+            test.execute(Tick{600});
+            test.execute(ExpectSegment{}.with_data("abc"));
+            test.execute(ExpectRetransmissionTimeout{1000});
+            test.execute(Tick{999});
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{1});
+            test.execute(ExpectSegment{}.with_data("abc"));
+            test.execute(ExpectRetransmissionTimeout{1000});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+
+            TCPSenderTestHarness test{"RTT is measured but the RTO stays fixed by default", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(Tick{100});
+            test.execute(AckReceived{WrappingInt32{isn + 1}});
+            test.execute(ExpectRTTEstimate{100, 50});
+            test.execute(ExpectRetransmissionTimeout{TCPConfig::TIMEOUT_DFLT});
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,146 @@
+#include "sender_harness.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+        const size_t MSS = TCPConfig::MAX_PAYLOAD_SIZE;
+        const uint16_t WIN = 65000;
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.sack = true;
+            // sequence number of the i-th data segment
+            const auto s = [&](size_t i) { return isn + 1 + uint32_t(i * MSS); };
+
+            TCPSenderTestHarness test{"SACK recovery retransmits only the holes", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(WIN));
+            test.execute(WriteBytes{string(10 * MSS, 'x')});
+            for (size_t i = 0; i < 10; ++i) {
+                test.execute(ExpectSegment{}.with_payload_size(MSS));
+            }
+
+            // segments 0 and 4 are lost; three duplicates SACKing 1..3 retransmit segment 0
+            test.execute(AckReceived{s(0)}.with_win(WIN).with_sack(s(1), s(2)));
+            test.execute(AckReceived{s(0)}.with_win(WIN).with_sack(s(1), s(3)));
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{s(0)}.with_win(WIN).with_sack(s(1), s(4)));
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(s(0)));
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectFastRecovery{true});
+            test.execute(ExpectPipe{7 * MSS});
+
+            // a duplicate without new SACK information is not counted and changes nothing
+            test.execute(AckReceived{s(0)}.with_win(WIN).with_sack(s(1), s(4)));
+            test.execute(ExpectNoSegment{});
+
+            // segment 4 is lost once three segments above it are SACKed, and goes out on its own
+            test.execute(AckReceived{s(0)}.with_win(WIN).with_sack(s(5), s(6)).with_sack(s(1), s(4)));
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{s(0)}.with_win(WIN).with_sack(s(5), s(8)).with_sack(s(1), s(4)));
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(s(4)));
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectPipe{4 * MSS});
+
+            // the retransmission of segment 0 fills the first hole; SACKed segments are never resent
+            test.execute(AckReceived{s(4)}.with_win(WIN).with_sack(s(5), s(8)));
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectFastRecovery{true});
+            test.execute(ExpectBytesInFlight{6 * MSS});
+            test.execute(ExpectPipe{3 * MSS});
+
+            test.execute(AckReceived{s(10)}.with_win(WIN));
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectFastRecovery{false});
+            test.execute(ExpectPipe{0});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.sack = true;
+            const auto s = [&](size_t i) { return isn + 1 + uint32_t(i * MSS); };
+
+            TCPSenderTestHarness test{"After a timeout every segment that was not SACKed is resent", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(WIN));
+            test.execute(WriteBytes{string(6 * MSS, 'x')});
+            for (size_t i = 0; i < 6; ++i) {
+                test.execute(ExpectSegment{}.with_payload_size(MSS));
+            }
+            test.execute(AckReceived{s(0)}.with_win(WIN).with_sack(s(2), s(3)));
+            test.execute(Tick{TCPConfig::TIMEOUT_DFLT});
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(s(0)));
+            test.execute(ExpectNoSegment{});
+
+            // once the retransmission is acked, the remaining holes go out together
+            test.execute(AckReceived{s(1)}.with_win(WIN).with_sack(s(2), s(3)));
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(s(5)));
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(s(4)));
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(s(3)));
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(s(1)));
+            test.execute(ExpectNoSegment{});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.congestion_control = CongestionControlAlgorithm::NewReno;
+            const auto s = [&](size_t i) { return isn + 1 + uint32_t(i * MSS); };
+
+            TCPSenderTestHarness test{"With congestion control, the pipe limits what recovery sends", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(WIN));
+            test.execute(WriteBytes{string(20 * MSS, 'x')});
+            for (size_t i = 0; i < 10; ++i) {
+                test.execute(ExpectSegment{}.with_payload_size(MSS));
+            }
+
+            // segments 0..2 are lost; each SACK takes a segment out of the pipe, so new data keeps flowing
+            test.execute(AckReceived{s(0)}.with_win(WIN).with_sack(s(3), s(4)));
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(s(10)));
+            test.execute(AckReceived{s(0)}.with_win(WIN).with_sack(s(3), s(5)));
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(s(11)));
+            test.execute(ExpectNoSegment{});
+
+            // the third duplicate halves the 12 segments in flight: cwnd = ssthresh + 3 = 9 segments,
+            // and the pipe (12 - 3 SACKed - 2 lost = 7) leaves room to resend all three holes
+            test.execute(AckReceived{s(0)}.with_win(WIN).with_sack(s(3), s(6)));
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(s(2)));
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(s(1)));
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(s(0)));
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectCongestionWindow{9 * MSS});
+            test.execute(ExpectPipe{9 * MSS});
+
+            // further SACKs do not inflate the window, they only shrink the pipe
+            test.execute(AckReceived{s(0)}.with_win(WIN).with_sack(s(3), s(7)));
+            test.execute(ExpectSegment{}.with_payload_size(MSS).with_seqno(s(12)));
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectCongestionWindow{9 * MSS});
+
+            // a partial ack sets the window to ssthresh
+            test.execute(AckReceived{s(2)}.with_win(WIN).with_sack(s(3), s(7)));
+            test.execute(ExpectFastRecovery{true});
+            test.execute(ExpectCongestionWindow{6 * MSS});
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -15,6 +15,7 @@
 #include <optional>
 #include <sstream>
 #include <string>
+#include <vector>
 
 const unsigned int DEFAULT_TEST_WINDOW = 137;
 
@@ -99,6 +100,114 @@ struct ExpectBytesInFlight : public SenderExpectation {
     }
 };
 
+struct ExpectCongestionWindow : public SenderExpectation {
+    size_t _n_bytes;
+
+    ExpectCongestionWindow(size_t n_bytes) : _n_bytes(n_bytes) {}
+    std::string description() const { return "congestion window of " + std::to_string(_n_bytes) + " bytes"; }
+
+    void execute(TCPSender &sender, std::deque<TCPSegment> &) const {
+        if (sender.congestion_window() != _n_bytes) {
+            std::ostringstream ss;
+            ss << "The TCPSender reported a congestion window of " << sender.congestion_window()
+               << " bytes, but it was expected to be " << _n_bytes << " bytes";
+            throw SenderExpectationViolation(ss.str());
+        }
+    }
+};
+
+struct ExpectFastRecovery : public SenderExpectation {
+    bool _in_recovery;
+
+    ExpectFastRecovery(bool in_recovery) : _in_recovery(in_recovery) {}
+    std::string description() const { return _in_recovery ? "in fast recovery" : "not in fast recovery"; }
+
+    void execute(TCPSender &sender, std::deque<TCPSegment> &) const {
+        if (sender.in_fast_recovery() != _in_recovery) {
+            throw SenderExpectationViolation(std::string("The TCPSender was ") +
+                                             (sender.in_fast_recovery() ? "" : "not ") +
+                                             "in fast recovery, but was expected to be the opposite");
+        }
+    }
+};
+
+struct ExpectPipe : public SenderExpectation {
+    size_t _bytes;
+
+    ExpectPipe(size_t bytes) : _bytes(bytes) {}
+    std::string description() const { return "pipe of " + std::to_string(_bytes) + " bytes"; }
+
+    void execute(TCPSender &sender, std::deque<TCPSegment> &) const {
+        if (sender.pipe_size() != _bytes) {
+            throw SenderExpectationViolation("The TCPSender estimated " + std::to_string(sender.pipe_size()) +
+                                             " bytes in the pipe, but " + std::to_string(_bytes) +
+                                             " were expected");
+        }
+    }
+};
+
+struct ExpectRetransmissionTimeout : public SenderExpectation {
+    size_t _ms;
+
+    ExpectRetransmissionTimeout(size_t ms) : _ms(ms) {}
+    std::string description() const { return "retransmission timeout of " + std::to_string(_ms) + " ms"; }
+
+    void execute(TCPSender &sender, std::deque<TCPSegment> &) const {
+        if (sender.retransmission_timeout() != _ms) {
+            std::ostringstream ss;
+            ss << "The TCPSender reported a retransmission timeout of " << sender.retransmission_timeout()
+               << " ms, but it was expected to be " << _ms << " ms";
+            throw SenderExpectationViolation(ss.str());
+        }
+    }
+};
+
+struct ExpectRTTEstimate : public SenderExpectation {
+    double _srtt;
+    double _rttvar;
+
+    ExpectRTTEstimate(double srtt, double rttvar) : _srtt(srtt), _rttvar(rttvar) {}
+    std::string description() const {
+        std::ostringstream ss;
+        ss << "srtt of " << _srtt << " ms and rttvar of " << _rttvar << " ms";
+        return ss.str();
+    }
+
+    void execute(TCPSender &sender, std::deque<TCPSegment> &) const {
+        if (sender.srtt() != _srtt or sender.rttvar() != _rttvar) {
+            std::ostringstream ss;
+            ss << "The TCPSender reported srtt = " << sender.srtt().value_or(-1) << " ms and rttvar = "
+               << sender.rttvar() << " ms, but they were expected to be " << _srtt << " ms and " << _rttvar
+               << " ms";
+            throw SenderExpectationViolation(ss.str());
+        }
+    }
+};
+
+struct ExpectPacingRate : public SenderExpectation {
+    std::optional<double> _rate;
+
+    ExpectPacingRate(std::optional<double> rate) : _rate(rate) {}
+    std::string description() const {
+        std::ostringstream ss;
+        if (_rate.has_value()) {
+            ss << "pacing rate of " << *_rate << " bytes/ms";
+        } else {
+            ss << "no pacing";
+        }
+        return ss.str();
+    }
+
+    void execute(TCPSender &sender, std::deque<TCPSegment> &) const {
+        if (sender.pacing_rate() != _rate) {
+            std::ostringstream ss;
+            ss << "The TCPSender reported a pacing rate of " << sender.pacing_rate().value_or(-1)
+               << " bytes/ms, but it was expected to be " << _rate.value_or(-1) << " bytes/ms";
+            throw SenderExpectationViolation(ss.str());
+        }
+    }
+};
+
 struct ExpectNoSegment : public SenderExpectation {
     ExpectNoSegment() {}
     std::string description() const { return "no (more) segments"; }
@@ -179,6 +288,7 @@ struct Tick : public SenderAction {
 struct AckReceived : public SenderAction {
     WrappingInt32 _ackno;
     std::optional<uint16_t> _window_advertisement{};
+    TCPHeader::SACKBlocks _sack_blocks{};
 
     AckReceived(WrappingInt32 ackno) : _ackno(ackno) {}
     std::string description() const {
@@ -192,8 +302,13 @@ struct AckReceived : public SenderAction {
         return *this;
     }
 
+    AckReceived &with_sack(WrappingInt32 left, WrappingInt32 right) {
+        _sack_blocks.push_back({left, right});
+        return *this;
+    }
+
     void execute(TCPSender &sender, std::deque<TCPSegment> &) const {
-        if (not sender.ack_received(_ackno, _window_advertisement.value_or(DEFAULT_TEST_WINDOW))) {
+        if (not sender.ack_received(_ackno, _window_advertisement.value_or(DEFAULT_TEST_WINDOW), true, _sack_blocks)) {
             sender.send_empty_segment();
         }
         sender.fill_window();
@@ -385,7 +500,7 @@ class TCPSenderTestHarness {
   public:
     TCPSenderTestHarness(const std::string &name_, TCPConfig config)
         : outbound_segments()
-        , sender(config.send_capacity, config.rt_timeout, config.fixed_isn)
+        , sender(config)
         , steps_executed()
         , name(name_) {
         sender.fill_window();
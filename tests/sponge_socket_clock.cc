@@ -0,0 +1,87 @@
+#include "tcp_config.hh"
+#include "tcp_connection.hh"
+#include "tcp_segment.hh"
+#include "tcp_sponge_socket.hh"
+#include "test_err_if.hh"
+#include "util.hh"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+using namespace std;
+
+// the peer is a TCPConnection on a plain UDP socket, driven by hand so that the test decides when it answers
+static TCPSegment recv_segment(UDPSocket &sock, Address &from) {
+    auto datagram = sock.recv();
+    from = datagram.source_address;
+    TCPSegment seg;
+    if (seg.parse(move(datagram.payload), 0) != ParseResult::NoError) {
+        throw runtime_error("the peer got a segment that failed to parse");
+    }
+    return seg;
+}
+
+static void send_segments(TCPConnection &conn, UDPSocket &sock, const Address &to) {
+    while (not conn.segments_out().empty()) {
+        sock.sendto(to, conn.segments_out().front().serialize(0));
+        conn.segments_out().pop();
+    }
+}
+
+int main() {
+    try {
+        UDPSocket peer_sock;
+        peer_sock.bind(Address("127.0.0.1", 0));
+        TCPConnection peer{TCPConfig{}};
+
+        // the client's RTO follows its RTT samples, starting from 1 s
+        TCPConfig cfg;
+        cfg.adaptive_rto = true;
+        FdAdapterConfig ad;
+        ad.destination = peer_sock.local_address();
+        TCPOverUDPSpongeSocket client{UDPSocket{}};
+
+        exception_ptr connect_error{};
+        thread connector([&] {
+            try {
+                client.connect(cfg, ad);
+            } catch (...) {
+                connect_error = current_exception();
+            }
+        });
+
+        // the SYN-ACK comes 300 ms after the SYN, while the client's event loop sleeps on its 1 s timer
+        Address client_addr = ad.destination;
+        peer.segment_received(recv_segment(peer_sock, client_addr));
+        this_thread::sleep_for(chrono::milliseconds(300));
+        send_segments(peer, peer_sock, client_addr);
+        peer.segment_received(recv_segment(peer_sock, client_addr));
+        connector.join();
+        if (connect_error) {
+            rethrow_exception(connect_error);
+        }
+
+        // the peer never acknowledges the data, so the client retransmits it after one RTO; a 300 ms sample
+        // gives an RTO of 900 ms, while a sample taken with the clock of the moment the loop went to sleep
+        // (about 0 ms) would give the 200 ms floor
+        client.write("hello");
+        const TCPSegment data = recv_segment(peer_sock, client_addr);
+        const uint64_t sent_at = timestamp_ms();
+        test_err_if(data.payload().str() != "hello", "the peer should get the data");
+        const TCPSegment retx = recv_segment(peer_sock, client_addr);
+        const uint64_t rto = timestamp_ms() - sent_at;
+        test_err_if(retx.payload().str() != "hello", "the client should retransmit the data");
+        test_err_if(rto < 600, "the RTT sample should be near 300 ms, but the RTO was " + to_string(rto) + " ms");
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,68 @@
+#ifndef SPONGE_TESTS_TCP_PAIR_HARNESS_HH
+#define SPONGE_TESTS_TCP_PAIR_HARNESS_HH
+
+#include "tcp_connection.hh"
+#include "tcp_segment.hh"
+#include "test_err_if.hh"
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <vector>
+
+//! \file
+//! \brief Helpers for tests that run two TCPConnections against each other in memory
+
+//! Decides whether the `index`th segment of one deliver() call is lost on the way
+using SegmentDropper = std::function<bool(const size_t index, const TCPSegment &seg)>;
+
+//! What one deliver() call moved
+struct Delivery {
+    size_t segments = 0;         //!< segments taken from the sender, including dropped ones
+    size_t largest_payload = 0;  //!< largest payload among them
+};
+
+//! \brief Move every pending segment from `from` to `to`, unless `drop` says it is lost
+//! \details Each segment is serialized and parsed again, so options really go over the wire.
+inline Delivery deliver(TCPConnection &from, TCPConnection &to, const SegmentDropper &drop = {}) {
+    Delivery delivery{};
+    for (; not from.segments_out().empty(); ++delivery.segments) {
+        TCPSegment parsed;
+        if (parsed.parse(from.segments_out().front().serialize().concatenate()) != ParseResult::NoError) {
+            throw std::runtime_error("segment failed to parse");
+        }
+        from.segments_out().pop();
+        delivery.largest_payload = std::max(delivery.largest_payload, parsed.payload().size());
+        if (not drop or not drop(delivery.segments, parsed)) {
+            to.segment_received(parsed);
+        }
+    }
+    return delivery;
+}
+
+//! Drop the segments at the listed positions
+inline SegmentDropper drop_indices(const std::vector<size_t> &indices) {
+    return [indices](const size_t index, const TCPSegment &) {
+        return std::find(indices.begin(), indices.end(), index) != indices.end();
+    };
+}
+
+//! Drop segments whose payload and options exceed `path_mss`, like a path MTU that discards big packets
+//! without telling anyone
+inline SegmentDropper drop_larger_than(const size_t path_mss) {
+    return [path_mss](const size_t, const TCPSegment &seg) {
+        return seg.payload().size() + seg.header().options.size() > path_mss;
+    };
+}
+
+//! Run the three-way handshake with `client` opening actively
+inline void handshake(TCPConnection &client, TCPConnection &server) {
+    client.connect();
+    deliver(client, server);
+    deliver(server, client);
+    deliver(client, server);
+    test_err_if(not client.active() or not server.active(), "the handshake should complete");
+}
+
+#endif  // SPONGE_TESTS_TCP_PAIR_HARNESS_HH
@@ -137,6 +137,7 @@ int main(int argc, char **argv) {
         }
 
         bool ok = true;
+        size_t with_options = 0;
         const uint8_t *pkt;
         struct pcap_pkthdr hdr;
         while ((pkt = pcap_next(pcap, &hdr)) != nullptr) {
@@ -198,6 +199,7 @@ int main(int argc, char **argv) {
                 tcp_hdr_copy = tcp_hdr_orig;
                 // fix up segment to remove IPv4 and TCP header extensions
                 tcp_hdr_copy.doff = 5;
+                tcp_hdr_copy.options = {};
             }  // tcp_hdr_{orig,copy} go out of scope
 
             if (!compare_tcp_headers_nolen(tcp_seg.header(), tcp_seg_copy.header())) {
@@ -230,9 +232,41 @@ int main(int argc, char **argv) {
                 ok = false;
                 continue;
             }
+
+            // the options round-trip: re-serializing the original header reproduces the option bytes off the
+            // wire (laid out the way Linux lays them out), and parsing those gives back the same options
+            if (!tcp_seg.header().options.empty()) {
+                ++with_options;
+                const TCPHeader &tcp_hdr_orig = tcp_seg.header();
+                const string wire_options(reinterpret_cast<const char *>(tcp_seg_data) + TCPHeader::LENGTH,
+                                          4 * tcp_hdr_orig.doff - TCPHeader::LENGTH);
+                const string reserialized = tcp_hdr_orig.serialize();
+                if (reserialized.substr(TCPHeader::LENGTH) != wire_options) {
+                    cout << "ERROR: after unparsing, TCP options don't match the original bytes:\n"
+                         << tcp_hdr_orig.options.to_string();
+                    ok = false;
+                    continue;
+                }
+                TCPHeader tcp_hdr_reparsed;
+                NetParser p{string(reserialized)};
+                if (const auto res = tcp_hdr_reparsed.parse(p); res != ParseResult::NoError) {
+                    cout << "ERROR got parse failure " << as_string(res) << " for re-serialized options\n";
+                    ok = false;
+                    continue;
+                }
+                if (!(tcp_hdr_reparsed.options == tcp_hdr_orig.options) || tcp_hdr_reparsed.doff != tcp_hdr_orig.doff) {
+                    cout << "ERROR: after re-parsing, TCP options don't match.\n";
+                    ok = false;
+                    continue;
+                }
+            }
         }
 
         pcap_close(pcap);
+        if (with_options == 0) {
+            cout << "ERROR: no segment in the capture carried TCP options\n";
+            ok = false;
+        }
         if (!ok) {
             return EXIT_FAILURE;
         }
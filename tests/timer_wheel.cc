@@ -0,0 +1,106 @@
+#include "tcp_config.hh"
+#include "tcp_connection.hh"
+#include "tcp_pair_harness.hh"
+#include "test_should_be.hh"
+#include "timer_wheel.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+int main() {
+    try {
+        {
+            TimerWheel wheel{3, 8, 10};
+            vector<TimerWheel::TimerId> fired{};
+            const auto fire = [&](const TimerWheel::TimerId id) { fired.push_back(id); };
+
+            test_should_be(wheel.time_until_next(), optional<uint64_t>{});
+            // timer 2 is several turns of the wheel (8 slots of 10 ms) away
+            wheel.arm(0, 35);
+            wheel.arm(1, 20);
+            wheel.arm(2, 500);
+            test_should_be(wheel.time_until_next(), optional<uint64_t>{20});
+
+            wheel.advance(19, fire);
+            test_err_if(not fired.empty(), "nothing is due before 20 ms");
+            wheel.advance(20, fire);
+            test_err_if((fired != vector<TimerWheel::TimerId>{1, 0}), "timers fire in deadline order");
+            test_err_if(wheel.armed(0) or wheel.armed(1) or not wheel.armed(2), "fired timers are disarmed");
+
+            // re-arming moves a timer, disarming removes it
+            wheel.arm(0, 100);
+            wheel.arm(0, 60);
+            wheel.arm(1, 50);
+            wheel.disarm(1);
+            fired.clear();
+            wheel.advance(21, fire);
+            test_err_if(fired != vector<TimerWheel::TimerId>{0}, "only the re-armed timer fires");
+
+            // a long jump passes the far timer's slot many times but fires it only when due
+            fired.clear();
+            wheel.advance(439, fire);
+            test_err_if(not fired.empty(), "the far timer is not due yet");
+            test_should_be(wheel.time_until_next(), optional<uint64_t>{1});
+            wheel.advance(1000, fire);
+            test_err_if(fired != vector<TimerWheel::TimerId>{2}, "the far timer fires");
+
+            // an overdue deadline fires on the next advance, and a callback may re-arm its own timer
+            wheel.arm(1, 0);
+            test_should_be(wheel.time_until_next(), optional<uint64_t>{0});
+            fired.clear();
+            wheel.advance(0, [&](const TimerWheel::TimerId id) {
+                fired.push_back(id);
+                wheel.arm(id, wheel.now() + 5);
+            });
+            test_err_if(fired != vector<TimerWheel::TimerId>{1}, "the overdue timer fires");
+            test_should_be(wheel.time_until_next(), optional<uint64_t>{5});
+        }
+
+        {
+            TCPConfig cfg;
+            TCPConnection client{cfg}, server{cfg};
+
+            test_should_be(client.time_until_next_timer(), optional<size_t>{});
+            client.connect();
+            test_should_be(client.time_until_next_timer(), optional<size_t>{cfg.rt_timeout});
+            client.tick(300);
+            test_should_be(client.time_until_next_timer(), optional<size_t>{cfg.rt_timeout - 300u});
+            deliver(client, server);
+            deliver(server, client);
+            deliver(client, server);
+            // an idle established connection needs no wake-ups
+            test_should_be(client.time_until_next_timer(), optional<size_t>{});
+            test_should_be(server.time_until_next_timer(), optional<size_t>{});
+
+            // the active closer lingers for 10 * rt_timeout after the last segment it received
+            client.end_input_stream();
+            deliver(client, server);
+            deliver(server, client);
+            server.end_input_stream();
+            deliver(server, client);
+            deliver(client, server);
+            test_err_if(server.active(), "the server is done");
+            test_should_be(server.time_until_next_timer(), optional<size_t>{});
+            test_should_be(client.time_until_next_timer(), optional<size_t>{10u * cfg.rt_timeout});
+            client.tick(10 * cfg.rt_timeout - 1);
+            test_err_if(not client.active(), "still lingering");
+            test_should_be(client.time_until_next_timer(), optional<size_t>{1});
+            client.tick(1);
+            test_err_if(client.active(), "the linger timer fired");
+            test_should_be(client.time_until_next_timer(), optional<size_t>{});
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}